@@ -0,0 +1,89 @@
+set(AUTOANY_CMAKE_FOUND TRUE)
+
+# AddAutoAnyModule(<target>
+#         MODULE <name>
+#         BASE_PATH <dir>
+#         OUTPUT_DIR <dir>
+#         [INCLUDE_PREFIX <prefix>]
+#         [SHARDS <n>]
+#         [OPTIONS <autoany options>...]
+#         HEADERS <header>...)
+#
+# 为 target 添加 autoany 生成的反射代码。所有头文件共用一条生成命令，命令写出 depfile 记录每个输出依赖的头文件
+# （源头文件和 @include_from 引入的头文件）。内容未变化的输出保持 mtime，Ninja 下 restat 会跳过它们的重新编译。
+# 优先使用同一构建中的 autoany 目标，否则使用 AUTOANY_EXECUTABLE 或在 PATH 中查找。
+function(AddAutoAnyModule target)
+    cmake_parse_arguments(ARG "" "MODULE;BASE_PATH;OUTPUT_DIR;INCLUDE_PREFIX;SHARDS" "OPTIONS;HEADERS" ${ARGN})
+
+    if (NOT ARG_MODULE OR NOT ARG_BASE_PATH OR NOT ARG_OUTPUT_DIR OR NOT ARG_HEADERS)
+        message(FATAL_ERROR "AddAutoAnyModule: MODULE, BASE_PATH, OUTPUT_DIR and HEADERS are required")
+    endif ()
+
+    if (TARGET autoany)
+        set(AUTOANY_COMMAND $<TARGET_FILE:autoany>)
+        set(AUTOANY_DEPENDS autoany)
+    else ()
+        if (NOT AUTOANY_EXECUTABLE)
+            find_program(AUTOANY_EXECUTABLE autoany REQUIRED)
+        endif ()
+        set(AUTOANY_COMMAND ${AUTOANY_EXECUTABLE})
+        set(AUTOANY_DEPENDS ${AUTOANY_EXECUTABLE})
+    endif ()
+
+    get_filename_component(BASE_PATH ${ARG_BASE_PATH} ABSOLUTE)
+    get_filename_component(OUTPUT_DIR ${ARG_OUTPUT_DIR} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_BINARY_DIR})
+    set(DEPFILE ${OUTPUT_DIR}/${ARG_MODULE}.d)
+
+    # 输出文件名与 autoany 的命名规则一致，reg_ 开头的头文件会被 autoany 忽略
+    set(HEADERS)
+    set(OUTPUTS ${OUTPUT_DIR}/reg_${ARG_MODULE}.cpp)
+    foreach (header ${ARG_HEADERS})
+        get_filename_component(header ${header} ABSOLUTE)
+        get_filename_component(header_name ${header} NAME_WE)
+        if (header_name MATCHES "^reg_")
+            continue()
+        endif ()
+        list(APPEND HEADERS ${header})
+        if (NOT ARG_SHARDS)
+            list(APPEND OUTPUTS ${OUTPUT_DIR}/ref_${header_name}.cpp)
+        endif ()
+    endforeach ()
+
+    set(ARGS -m ${ARG_MODULE} -b ${BASE_PATH} -o ${OUTPUT_DIR} -d ${DEPFILE})
+    if (ARG_INCLUDE_PREFIX)
+        list(APPEND ARGS -p ${ARG_INCLUDE_PREFIX})
+    endif ()
+    if (ARG_SHARDS)
+        list(APPEND ARGS -n ${ARG_SHARDS})
+        math(EXPR LAST_SHARD "${ARG_SHARDS} - 1")
+        foreach (shard RANGE ${LAST_SHARD})
+            list(APPEND OUTPUTS ${OUTPUT_DIR}/ref_${ARG_MODULE}_shard${shard}.cpp)
+        endforeach ()
+    endif ()
+
+    set(BYPRODUCTS ${OUTPUT_DIR}/autoany.manifest ${OUTPUT_DIR}/autoany_enum.h)
+    foreach (option ${ARG_OPTIONS})
+        if (option STREQUAL "--lazy" OR option STREQUAL "-l")
+            list(APPEND BYPRODUCTS ${OUTPUT_DIR}/autoany_lazy.h)
+        elseif (option STREQUAL "--tables" OR option STREQUAL "-t")
+            list(APPEND BYPRODUCTS ${OUTPUT_DIR}/autoany_table.h)
+        elseif (option STREQUAL "--profile" OR option STREQUAL "-P")
+            list(APPEND BYPRODUCTS ${OUTPUT_DIR}/autoany_profile.h)
+        elseif (option STREQUAL "--emit-manifest" OR option STREQUAL "-e")
+            list(APPEND BYPRODUCTS ${OUTPUT_DIR}/${ARG_MODULE}.types.json)
+        endif ()
+    endforeach ()
+
+    add_custom_command(
+            OUTPUT ${OUTPUTS}
+            BYPRODUCTS ${BYPRODUCTS}
+            COMMAND ${AUTOANY_COMMAND} ${ARGS} ${ARG_OPTIONS} ${HEADERS}
+            DEPENDS ${AUTOANY_DEPENDS} ${HEADERS}
+            DEPFILE ${DEPFILE}
+            COMMENT "Generating reflection code for module ${ARG_MODULE}"
+            VERBATIM
+    )
+
+    target_sources(${target} PRIVATE ${OUTPUTS})
+    target_include_directories(${target} PRIVATE ${OUTPUT_DIR})
+endfunction(AddAutoAnyModule)
@@ -0,0 +1,127 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "alloc_counter.h"
+
+#include <cstddef>
+#include <cstdlib>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+#include <new>
+
+
+/**
+ * 只在基准测试中替换全局 new/delete，为 AllocCounter 计数.
+ * 对齐要求不超过 max_align_t 时用 malloc/free，否则用对齐分配，释放时按同样的条件选择，
+ * Windows 上 _aligned_free 不能释放 malloc 得到的指针.
+ */
+static const bool sHooksInstalled = (AllocCounter::enable(), true);
+
+static bool isOverAligned(size_t alignment)
+{
+    return alignment > alignof(std::max_align_t);
+}
+
+static void *countedAlloc(size_t size, size_t alignment)
+{
+    AllocCounter::add();
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        void *p = nullptr;
+        if (!isOverAligned(alignment)) {
+            p = std::malloc(size);
+        } else {
+#if defined(_WIN32)
+            p = _aligned_malloc(size, alignment);
+#else
+            p = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+        }
+        if (p) {
+            return p;
+        }
+        // 与默认的 operator new 一致：有 new_handler 时调用后重试，否则抛出 bad_alloc
+        const std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+static void countedFree(void *p, size_t alignment)
+{
+#if defined(_WIN32)
+    if (isOverAligned(alignment)) {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void) alignment;
+#endif
+    std::free(p);
+}
+
+void *operator new(size_t size)
+{
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+
+void *operator new[](size_t size)
+{
+    return countedAlloc(size, alignof(std::max_align_t));
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    return countedAlloc(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::align_val_t alignment) noexcept
+{
+    countedFree(p, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void *p, std::align_val_t alignment) noexcept
+{
+    countedFree(p, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *p, size_t, std::align_val_t alignment) noexcept
+{
+    countedFree(p, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void *p, size_t, std::align_val_t alignment) noexcept
+{
+    countedFree(p, static_cast<size_t>(alignment));
+}
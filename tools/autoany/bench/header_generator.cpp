@@ -0,0 +1,122 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "header_generator.h"
+
+#include <algorithm>
+#include <sstream>
+
+
+static void genEnum(std::ostream &os, const std::string &indent, const std::string &name, size_t items)
+{
+    os << indent << "/**\n"
+        << indent << " * @enum " << name << "\n";
+    for (size_t i = 0; i < items; i++) {
+        os << indent << " * @enum_item Item" << i << "\n";
+    }
+    os << indent << " */\n"
+        << indent << "enum class " << name << "\n"
+        << indent << "{\n";
+    for (size_t i = 0; i < items; i++) {
+        os << indent << "    Item" << i << " = " << i * 2 << ",\n";
+    }
+    os << indent << "};\n\n";
+}
+
+static void genClassBody(std::ostream &os, const HeaderGenerator::Options &options, const std::string &indent,
+                         const std::string &className, const std::string &uniqueName, size_t depth)
+{
+    // 枚举名在整个文件内唯一，避免短名解析到其他类的同名枚举
+    const std::string enumName = uniqueName + "Mode";
+
+    os << indent << "public:\n";
+    genEnum(os, indent + "    ", enumName, options.enumItems);
+
+    os << indent << "    /** @construct */\n"
+        << indent << "    " << className << "(int32_t id, const std::string &name = \"\", " << enumName << " mode = "
+        << enumName << "::Item0);\n\n";
+
+    for (size_t f = 0; f < options.funcs; f++) {
+        const size_t nameIndex = f / std::max<size_t>(options.overloads, 1);
+        const size_t overload = f % std::max<size_t>(options.overloads, 1);
+
+        os << indent << "    /**\n"
+            << indent << "     * @func\n"
+            << indent << "     * @brief Synthetic function " << f << " of " << className << ".\n"
+            << indent << "     * Calls into { braces } and \"strings\" to exercise the lexer.\n"
+            << indent << "     */\n"
+            << indent << "    virtual std::vector<int32_t> compute" << nameIndex << "(const " << className << " &other";
+        for (size_t a = 0; a <= overload; a++) {
+            os << ", float arg" << a;
+        }
+        os << ", " << enumName << " mode = " << enumName << "::Item1, bool flag = false) const;\n\n";
+    }
+
+    os << indent << "    /**\n"
+        << indent << "     * @static_func\n"
+        << indent << "     */\n"
+        << indent << "    static " << className << " create(int32_t id);\n\n";
+
+    os << indent << "    /**\n"
+        << indent << "     * @func\n"
+        << indent << "     * @property_get value\n"
+        << indent << "     */\n"
+        << indent << "    inline int32_t getValue() const { return mValue; }\n\n"
+        << indent << "    /**\n"
+        << indent << "     * @func\n"
+        << indent << "     * @property_set value\n"
+        << indent << "     */\n"
+        << indent << "    void setValue(int32_t value) { mValue = value; }\n\n"
+        << indent << "    /** @property name */\n"
+        << indent << "    std::string name;\n\n";
+
+    if (depth < options.nestedDepth) {
+        const std::string nestedName = "Nested" + std::to_string(depth);
+        os << indent << "    /**\n"
+            << indent << "     * @class " << nestedName << "\n"
+            << indent << "     */\n"
+            << indent << "    class " << nestedName << "\n"
+            << indent << "    {\n";
+        genClassBody(os, options, indent + "    ", nestedName, uniqueName + nestedName, depth + 1);
+        os << indent << "    };\n\n";
+    }
+
+    os << indent << "private:\n"
+        << indent << "    int32_t mValue = 0; // not reflected { }\n";
+}
+
+std::string HeaderGenerator::generate(const Options &options, size_t fileIndex)
+{
+    std::stringstream os;
+    const std::string prefix = "Bench" + std::to_string(fileIndex) + "_";
+
+    os << "//\n// Generated by autoany-bench.\n//\n\n"
+        << "#pragma once\n\n"
+        << "#include <cstdint>\n#include <string>\n#include <vector>\n\n"
+        << "/**\n * @cpp_ns bench\n * @using_ns std\n */\n"
+        << "namespace bench\n{\n\n";
+
+    genEnum(os, "", prefix + "Kind", options.enumItems);
+
+    for (size_t c = 0; c < options.classes; c++) {
+        const std::string className = prefix + "Class" + std::to_string(c);
+        os << "/**\n"
+            << " * @class " << className << "\n"
+            << " * @ns Bench\n"
+            << " * Synthetic class " << c << ".\n"
+            << " */\n"
+            << "class " << className << "\n"
+            << "{\n";
+        genClassBody(os, options, "", className, className, 0);
+        os << "};\n\n";
+    }
+
+    os << "/**\n"
+        << " * @ref_code\n"
+        << " * Class<" << prefix << "Class0>(\"Bench\", \"" << prefix << "Extra\", \"\");\n"
+        << " */\n\n"
+        << "} // namespace bench\n";
+
+    return os.str();
+}
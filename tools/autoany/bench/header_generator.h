@@ -0,0 +1,31 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef HEADER_GENERATOR_H
+#define HEADER_GENERATOR_H
+
+#include <cstddef>
+#include <string>
+
+
+/**
+ * 生成带 autoany 注释标签的合成头文件，用于基准测试.
+ * 每个类包含构造函数、带默认参数的重载函数、属性、内部枚举和嵌套类，文件末尾附带枚举和 @ref_code 块.
+ */
+class HeaderGenerator
+{
+public:
+    struct Options
+    {
+        size_t classes = 20;    // 每个头文件的类数量
+        size_t funcs = 16;      // 每个类的函数数量
+        size_t overloads = 3;   // 每个函数名的重载数量
+        size_t enumItems = 8;   // 每个枚举的枚举项数量
+        size_t nestedDepth = 1; // 嵌套类层数
+    };
+
+    static std::string generate(const Options &options, size_t fileIndex);
+};
+
+#endif //HEADER_GENERATOR_H
@@ -0,0 +1,192 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "header_generator.h"
+#include "parser_bench.h"
+
+#include <gx/debug.h>
+#include <gx/gfile.h>
+
+#include <getopt/getopt.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+static size_t sFiles = 8;
+static size_t sIterations = 5;
+static std::string sOutput;
+static HeaderGenerator::Options sGenOptions;
+
+
+static const char *USAGE = R"TXT(Usage:
+APP_NAME [options]
+
+Generate synthetic annotated headers and measure each autoany parsing and generation stage.
+
+Options:
+    --help, -h
+        Print this message.
+    --files=N, -f N
+        Number of generated headers (default 8).
+    --classes=N, -c N
+        Classes per header (default 20).
+    --funcs=N, -u N
+        Functions per class, including overloads (default 16).
+    --overloads=N, -l N
+        Overloads per function name (default 3).
+    --enum-items=N, -e N
+        Items per enum (default 8).
+    --nested-depth=N, -d N
+        Depth of nested classes inside each class (default 1).
+    --iterations=N, -i N
+        Number of times the whole corpus is processed (default 5).
+    --output=string, -o string
+        Also write the generated headers to this directory, so they can be fed to autoany.
+)TXT";
+
+static void printUsage(const char *name)
+{
+    const std::string execName(GFile(name).fileName());
+    const std::string from("APP_NAME");
+    std::string usage(USAGE);
+    for (size_t pos = usage.find(from); pos != std::string::npos; pos = usage.find(from, pos)) {
+        usage.replace(pos, from.length(), execName);
+    }
+    puts(usage.c_str());
+}
+
+static size_t parseCount(const std::string &arg, size_t min)
+{
+    const long long value = strtoll(arg.c_str(), nullptr, 10);
+    return value < static_cast<long long>(min) ? min : static_cast<size_t>(value);
+}
+
+static void handleArguments(int argc, char *argv[])
+{
+    constexpr static const char *OPTSTR = "hf:c:u:l:e:d:i:o:";
+    static const option OPTIONS[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"files", required_argument, nullptr, 'f'},
+        {"classes", required_argument, nullptr, 'c'},
+        {"funcs", required_argument, nullptr, 'u'},
+        {"overloads", required_argument, nullptr, 'l'},
+        {"enum-items", required_argument, nullptr, 'e'},
+        {"nested-depth", required_argument, nullptr, 'd'},
+        {"iterations", required_argument, nullptr, 'i'},
+        {"output", required_argument, nullptr, 'o'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    int optionIndex = 0;
+
+    while ((opt = gp_getopt_long(argc, argv, OPTSTR, OPTIONS, &optionIndex)) >= 0) {
+        std::string arg(optarg ? optarg : "");
+        switch (opt) {
+            default:
+            case 'h': {
+                printUsage(argv[0]);
+                exit(0);
+            }
+            case 'f': {
+                sFiles = parseCount(arg, 1);
+            }
+            break;
+            case 'c': {
+                sGenOptions.classes = parseCount(arg, 1);
+            }
+            break;
+            case 'u': {
+                sGenOptions.funcs = parseCount(arg, 0);
+            }
+            break;
+            case 'l': {
+                sGenOptions.overloads = parseCount(arg, 1);
+            }
+            break;
+            case 'e': {
+                sGenOptions.enumItems = parseCount(arg, 1);
+            }
+            break;
+            case 'd': {
+                sGenOptions.nestedDepth = parseCount(arg, 0);
+            }
+            break;
+            case 'i': {
+                sIterations = parseCount(arg, 1);
+            }
+            break;
+            case 'o': {
+                sOutput = arg;
+            }
+            break;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    handleArguments(argc, argv);
+
+    std::vector<std::string> corpus;
+    corpus.reserve(sFiles);
+    for (size_t i = 0; i < sFiles; i++) {
+        corpus.push_back(HeaderGenerator::generate(sGenOptions, i));
+    }
+
+    if (!sOutput.empty()) {
+        const GFile outputDir(sOutput);
+        if (!outputDir.exists()) {
+            outputDir.mkdirs();
+        }
+        for (size_t i = 0; i < corpus.size(); i++) {
+            GFile file(outputDir, "bench_" + std::to_string(i) + ".h");
+            if (!file.open(GFile::WriteOnly)) {
+                LogE("Failed to write file: {}", file.absoluteFilePath());
+                return EXIT_FAILURE;
+            }
+            file.write(corpus[i]);
+            file.close();
+        }
+    }
+
+    // 预热一次，排除首次运行的缓存和分配器抖动
+    ParserBench::Result warmup;
+    ParserBench::run(corpus.front(), warmup);
+
+    ParserBench::Result result;
+    for (size_t iter = 0; iter < sIterations; iter++) {
+        for (const auto &source: corpus) {
+            ParserBench::run(source, result);
+        }
+    }
+
+    const double mb = static_cast<double>(result.bytes) / (1024.0 * 1024.0);
+    printf("headers: %zu x %zu iterations, %.2f MB per iteration\n", corpus.size(), sIterations, mb / static_cast<double>(sIterations));
+    printf("classes/header: %.1f, overloads/header: %.1f, output bytes/header: %.0f\n\n",
+           static_cast<double>(result.classes) / static_cast<double>(result.headers),
+           static_cast<double>(result.overloads) / static_cast<double>(result.headers),
+           static_cast<double>(result.outputBytes) / static_cast<double>(result.headers));
+
+    printf("%-30s %12s %12s %16s\n", "stage", "time (ms)", "MB/s", "allocs/header");
+    ParserBench::StageStats total;
+    for (size_t s = 0; s < ParserBench::STAGE_COUNT; s++) {
+        const auto &stats = result.stages[s];
+        total.nanoseconds += stats.nanoseconds;
+        total.allocations += stats.allocations;
+
+        const double ms = static_cast<double>(stats.nanoseconds) / 1e6;
+        printf("%-30s %12.3f %12.1f %16.1f\n", ParserBench::stageName(static_cast<ParserBench::Stage>(s)), ms,
+               ms > 0 ? mb / (ms / 1000.0) : 0.0,
+               static_cast<double>(stats.allocations) / static_cast<double>(result.headers));
+    }
+    const double totalMs = static_cast<double>(total.nanoseconds) / 1e6;
+    printf("%-30s %12.3f %12.1f %16.1f\n", "total", totalMs,
+           totalMs > 0 ? mb / (totalMs / 1000.0) : 0.0,
+           static_cast<double>(total.allocations) / static_cast<double>(result.headers));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "parser_bench.h"
+#include "alloc_counter.h"
+
+#include "cpp_types_info_gen.h"
+#include "to_any_gen.h"
+
+#include <chrono>
+#include <optional>
+
+
+const char *ParserBench::stageName(Stage stage)
+{
+    switch (stage) {
+        case ExtractCommentBlocks:
+            return "extractCommentBlocks";
+        case ParseCommentBlocks:
+            return "parseCommentBlocks";
+        case AssembleTypesInfo:
+            return "assembleTypesInfo";
+        case ResolveTypes:
+            return "resolveAllTypesFullQualified";
+        case GenReflecCode:
+            return "genReflecCode";
+        case ReleaseModel:
+            return "releaseModel";
+        default:
+            return "";
+    }
+}
+
+void ParserBench::run(std::string_view source, Result &result)
+{
+    auto measure = [&](Stage stage, auto &&fn) {
+        const uint64_t allocations = AllocCounter::count();
+        const auto begin = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        result.stages[stage].nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        result.stages[stage].allocations += AllocCounter::count() - allocations;
+    };
+
+    // 与 CppTypesInfoGen::parse 的步骤一致，只是每一步单独计时
+    std::optional<TypesInfo> typesInfo;
+    std::optional<ArenaVector<CppTypesInfoGen::CommentBlock> > commentBlocks;
+    std::optional<ArenaVector<CppTypesInfoGen::TagItem> > tags;
+    std::optional<ArenaVector<CppTypesInfoGen::ParsedItem> > parsedItems;
+
+    measure(ExtractCommentBlocks, [&] {
+        typesInfo.emplace(source.size() / 2 + 4096);
+        commentBlocks.emplace(CppTypesInfoGen::extractCommentBlocks(source, *typesInfo->arena));
+    });
+    measure(ParseCommentBlocks, [&] {
+        tags.emplace(typesInfo->arena->resource());
+        parsedItems.emplace(CppTypesInfoGen::parseCommentBlocks(*commentBlocks, *tags));
+    });
+    measure(AssembleTypesInfo, [&] {
+        CppTypesInfoGen::assembleTypesInfo(*parsedItems, *tags, *typesInfo);
+    });
+    measure(ResolveTypes, [&] {
+        CppTypesInfoGen::resolveAllTypesFullQualified(*typesInfo);
+    });
+    measure(GenReflecCode, [&] {
+        for (const auto &enumInfo: typesInfo->enumClasses) {
+            result.outputBytes += ToAnyGen::genReflecEnumClassCode(*typesInfo, enumInfo).size();
+        }
+        for (const auto &classInfo: typesInfo->classes) {
+            result.outputBytes += ToAnyGen::genReflecClassCode(*typesInfo, classInfo, {}).size();
+        }
+    });
+
+    result.headers++;
+    result.bytes += source.size();
+    result.classes += typesInfo->classes.size();
+    for (const auto &func: typesInfo->funcs) {
+        result.overloads += func.overloads.size();
+    }
+
+    measure(ReleaseModel, [&] {
+        parsedItems.reset();
+        tags.reset();
+        commentBlocks.reset();
+        typesInfo.reset();
+    });
+}
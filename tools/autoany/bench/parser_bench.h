@@ -0,0 +1,51 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef PARSER_BENCH_H
+#define PARSER_BENCH_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+
+/**
+ * 分阶段运行 CppTypesInfoGen 的解析流程和 ToAnyGen 的代码生成，累计每个阶段的耗时和内存分配次数.
+ */
+class ParserBench
+{
+public:
+    enum Stage
+    {
+        ExtractCommentBlocks,
+        ParseCommentBlocks,
+        AssembleTypesInfo,
+        ResolveTypes,
+        GenReflecCode,
+        ReleaseModel,
+        STAGE_COUNT
+    };
+
+    struct StageStats
+    {
+        uint64_t nanoseconds = 0;
+        uint64_t allocations = 0;
+    };
+
+    struct Result
+    {
+        std::array<StageStats, STAGE_COUNT> stages{};
+        uint64_t headers = 0;
+        uint64_t bytes = 0;
+        uint64_t classes = 0;
+        uint64_t overloads = 0;
+        uint64_t outputBytes = 0;
+    };
+
+    static const char *stageName(Stage stage);
+
+    static void run(std::string_view source, Result &result);
+};
+
+#endif //PARSER_BENCH_H
@@ -0,0 +1,137 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "to_any_gen.h"
+#include "output_file.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/**
+ * 生成 autoany_enum.h 和一个覆盖大量随机名字集合的翻译单元.
+ * 每个集合的 makeEnumNameHash、makeEnumIndex 在 static_assert 中求值，构建失败或查找结果不对都会导致编译失败；
+ * 排序回退表单独对一部分集合检查.
+ */
+
+static constexpr size_t SET_COUNT = 400;
+
+static std::string randomName(std::mt19937 &random)
+{
+    static constexpr std::string_view HEAD = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_";
+    static constexpr std::string_view TAIL = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_0123456789";
+    std::string name(1, HEAD[random() % HEAD.size()]);
+    for (uint32_t len = random() % 12; len > 0; len--) {
+        name.push_back(TAIL[random() % TAIL.size()]);
+    }
+    return name;
+}
+
+static void genSet(std::stringstream &os, size_t index, const std::vector<std::string> &names, bool wide, std::mt19937 &random)
+{
+    const std::string enumName = "E" + std::to_string(index);
+    os << "enum class " << enumName << (wide ? " : int64_t" : "") << "\n{\n";
+    std::set<int64_t> values;
+    for (size_t i = 0; i < names.size(); i++) {
+        os << "    v" << i;
+        if (wide) {
+            // 取值覆盖整个 int64_t 范围，包括两端
+            int64_t value = i == 0 ? INT64_MIN : i == 1 ? INT64_MAX : static_cast<int64_t>((uint64_t(random()) << 32) | random());
+            while (!values.insert(value).second) {
+                value++;
+            }
+            os << " = " << (value == INT64_MIN ? "INT64_MIN" : std::to_string(value) + "ll");
+        }
+        os << ",\n";
+    }
+    os << "};\n";
+
+    os << "static constexpr autoany::EnumItem<" << enumName << "> s" << enumName << "Items[] = {\n";
+    for (size_t i = 0; i < names.size(); i++) {
+        os << "    {" << enumName << "::v" << i << ", \"" << names[i] << "\"},\n";
+    }
+    os << "};\n";
+    os << "static constexpr auto s" << enumName << "Names = autoany::makeEnumNameHash(s" << enumName << "Items);\n";
+    os << "static_assert(checkNames(s" << enumName << "Names, s" << enumName << "Items));\n";
+    os << "static_assert(checkIndex(autoany::makeEnumIndex(s" << enumName << "Items), s" << enumName << "Items));\n";
+    if (index % 8 == 0) {
+        os << "static constexpr auto s" << enumName << "Sorted = autoany::makeSortedEnumNames(s" << enumName << "Items);\n";
+        os << "static_assert(checkNames(s" << enumName << "Sorted, s" << enumName << "Items));\n";
+    }
+    os << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <output dir>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const std::string outputDir = argv[1];
+
+    std::stringstream os;
+    os << "// Generated by autoany-enum-hash-check-gen.\n\n"
+        << "#include \"" << ToAnyGen::ENUM_HEADER_FILE_NAME << "\"\n\n"
+        << "#include <cstdint>\n"
+        << "#include <cstdio>\n\n"
+        << "template<typename Names, typename E, size_t N>\n"
+        << "constexpr bool checkNames(const Names &names, const autoany::EnumItem<E> (&items)[N])\n"
+        << "{\n"
+        << "    for (const auto &item: items) {\n"
+        << "        const E *value = names.find(item.name);\n"
+        << "        if (value == nullptr || *value != item.value) {\n"
+        << "            return false;\n"
+        << "        }\n"
+        << "    }\n"
+        << "    return names.find(\"-\") == nullptr && names.find(\"\") == nullptr;\n"
+        << "}\n\n"
+        << "template<typename Index, typename E, size_t N>\n"
+        << "constexpr bool checkIndex(const Index &index, const autoany::EnumItem<E> (&items)[N])\n"
+        << "{\n"
+        << "    for (const auto &item: items) {\n"
+        << "        if (std::string_view(index.name(item.value)) != item.name) {\n"
+        << "            return false;\n"
+        << "        }\n"
+        << "    }\n"
+        << "    return true;\n"
+        << "}\n\n";
+
+    std::mt19937 random(20261017);
+    size_t index = 0;
+
+    // 已知会让旧的位移公式失败的集合
+    genSet(os, index++, {"None", "Big", "Neg"}, false, random);
+    for (; index < SET_COUNT; index++) {
+        const size_t count = 1 + random() % (index % 10 == 0 ? 200 : 24);
+        std::set<std::string> unique;
+        std::vector<std::string> names;
+        while (names.size() < count) {
+            std::string name = randomName(random);
+            if (unique.insert(name).second) {
+                names.push_back(std::move(name));
+            }
+        }
+        genSet(os, index, names, index % 5 == 0, random);
+    }
+
+    os << "int main()\n"
+        << "{\n"
+        << "    printf(\"enum hash check: " << SET_COUNT << " name sets\\n\");\n"
+        << "    return 0;\n"
+        << "}\n";
+
+    const std::string headerPath = outputDir + "/" + ToAnyGen::ENUM_HEADER_FILE_NAME;
+    const std::string sourcePath = outputDir + "/enum_hash_check.cpp";
+    if (OutputFile::writeIfChanged(headerPath, std::string(ToAnyGen::enumHeaderCode())) == OutputFile::WriteResult::Failed ||
+        OutputFile::writeIfChanged(sourcePath, os.str()) == OutputFile::WriteResult::Failed) {
+        fprintf(stderr, "Failed to write to %s\n", outputDir.c_str());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
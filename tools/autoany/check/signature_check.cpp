@@ -0,0 +1,403 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "cpp_types_info_gen.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <regex>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+/**
+ * 差分检查：函数签名的函数名、返回类型和参数（类型、名字、是否有默认值），新的手写识别器与原来基于
+ * std::regex 和线性说明符扫描的实现必须得到相同的结果.
+ * 下面的 reference* 函数保持原实现的逻辑不变，只作为对照.
+ *
+ * 有意的差异只有参数列表中含有嵌套括号（函数类型、函数指针、带调用的默认值）或字面量默认值时：
+ * - 原实现在第一个 ')' 处截断参数列表，新实现取与 '(' 匹配的 ')'
+ * - 原实现分割参数时只跟踪 '<' '>'，新实现同时跟踪 '(' ')'
+ * - 新实现匹配括号和分割参数时跳过字符串和字符字面量，例如默认值 '(' 或 "a,b("
+ * 这类签名与打开这些差异的对照实现比较.
+ */
+
+static std::string referenceTrim(const std::string &str)
+{
+    const size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos)
+        return "";
+    const size_t last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+static bool referenceIsIdentChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || (c == '_');
+}
+
+static std::string referenceRemoveFunctionSpecifiers(const std::string &str)
+{
+    static const std::vector<std::string> specifiers = {
+        "inline",
+        "constexpr",
+        "virtual",
+        "explicit",
+        "friend",
+        "static",
+        "__stdcall",
+        "__cdecl",
+        "__thiscall",
+        "__fastcall",
+        "noexcept",
+        "mutable"
+    };
+
+    std::istringstream iss(str);
+    std::string token;
+    std::vector<std::string> tokens;
+
+    while (iss >> token) {
+        bool isSpecifier = false;
+        for (const auto &spec: specifiers) {
+            if (token == spec) {
+                isSpecifier = true;
+                break;
+            }
+        }
+        if (!isSpecifier) {
+            tokens.push_back(token);
+        }
+    }
+
+    std::ostringstream oss;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (i > 0)
+            oss << " ";
+        oss << tokens[i];
+    }
+    return oss.str();
+}
+
+static std::pair<std::string, std::string> referenceExtractFunctionNameAndReturnType(const std::string &sigHead, const std::string &className)
+{
+    const std::string trimmed = referenceTrim(sigHead);
+    std::string name;
+    std::string retType;
+
+    static const std::regex opRegex(R"(operator\s*(\[\]|==|!=|<=|>=|<=>|<|>|&&|\|\||\+|-|\*|/|%|\^|&|\||~|!|=|\(\)|\[\]|\w+(::\w+)*))");
+    std::smatch match;
+
+    if (std::regex_search(trimmed, match, opRegex)) {
+        name = "operator" + match.str(1);
+        retType = referenceRemoveFunctionSpecifiers(referenceTrim(trimmed.substr(0, match.position(0))));
+        return {name, retType};
+    }
+
+    size_t end = trimmed.size();
+    while (end > 0 && !referenceIsIdentChar(trimmed[end - 1]))
+        --end;
+
+    size_t start = end;
+    while (start > 0 && referenceIsIdentChar(trimmed[start - 1]))
+        --start;
+
+    name = trimmed.substr(start, end - start);
+    retType = referenceRemoveFunctionSpecifiers(referenceTrim(trimmed.substr(0, start)));
+
+    if (name == className) {
+        retType = "";
+    }
+
+    return {name, retType};
+}
+
+struct ReferenceArg
+{
+    std::string type;
+    std::string name;
+    bool hasDefault = false;
+};
+
+static std::string referenceStripDefaultValue(const std::string &param)
+{
+    const size_t eq = param.find('=');
+    if (eq != std::string::npos) {
+        return referenceTrim(param.substr(0, eq));
+    }
+    return referenceTrim(param);
+}
+
+/**
+ * 跳过 pos 处开始的 '...' 或 "..." 字面量，返回字面量之后的位置.
+ */
+static size_t referenceSkipLiteral(const std::string &str, size_t pos)
+{
+    size_t p = pos + 1;
+    while (p < str.size() && str[p] != str[pos]) {
+        p += str[p] == '\\' ? 2 : 1;
+    }
+    return std::min(p + 1, str.size());
+}
+
+/**
+ * 原实现的参数解析；nestedParens 打开上面列出的有意差异.
+ */
+static std::vector<ReferenceArg> referenceParseArguments(const std::string &sig, bool nestedParens)
+{
+    std::vector<ReferenceArg> args;
+    const size_t lparen = sig.find('(');
+    size_t rparen = sig.find(')');
+    if (nestedParens && lparen != std::string::npos) {
+        int level = 0;
+        rparen = std::string::npos;
+        for (size_t i = lparen; i < sig.size(); i++) {
+            if (sig[i] == '\'' || sig[i] == '"') {
+                i = referenceSkipLiteral(sig, i) - 1;
+            } else if (sig[i] == '(') {
+                ++level;
+            } else if (sig[i] == ')' && --level == 0) {
+                rparen = i;
+                break;
+            }
+        }
+    }
+    if (lparen == std::string::npos || rparen == std::string::npos || rparen < lparen)
+        return args;
+
+    const std::string insideParen = sig.substr(lparen + 1, rparen - lparen - 1);
+
+    std::vector<std::string> params;
+    std::string currentParam;
+    int parenLevel = 0;
+    for (size_t i = 0; i < insideParen.size(); i++) {
+        const char c = insideParen[i];
+        if (nestedParens && (c == '\'' || c == '"')) {
+            const size_t end = referenceSkipLiteral(insideParen, i);
+            currentParam.append(insideParen, i, end - i);
+            i = end - 1;
+        } else if (c == ',' && parenLevel == 0) {
+            params.push_back(referenceTrim(currentParam));
+            currentParam.clear();
+        } else {
+            if (c == '<' || (nestedParens && c == '('))
+                ++parenLevel;
+            if (c == '>' || (nestedParens && c == ')'))
+                --parenLevel;
+            currentParam += c;
+        }
+    }
+    if (!currentParam.empty())
+        params.push_back(referenceTrim(currentParam));
+
+    int unnamedCount = 0;
+    for (auto &p: params) {
+        const bool hasDefault = p.find('=') != std::string::npos;
+        p = referenceStripDefaultValue(p);
+        if (p.empty())
+            continue;
+
+        size_t nameEnd = p.size();
+        while (nameEnd > 0 && !referenceIsIdentChar(p[nameEnd - 1]))
+            --nameEnd;
+        size_t nameStart = nameEnd;
+        while (nameStart > 0 && referenceIsIdentChar(p[nameStart - 1]))
+            --nameStart;
+
+        std::string varName = p.substr(nameStart, nameEnd - nameStart);
+        if (varName.empty()) {
+            varName = "arg" + std::to_string(unnamedCount++);
+        }
+        args.push_back({referenceTrim(p.substr(0, nameStart)), varName, hasDefault});
+    }
+    return args;
+}
+
+/**
+ * 随机拼出函数签名头：说明符、返回类型、函数名（含各种运算符写法），token 之间的空白随机.
+ */
+class SignatureCorpus
+{
+public:
+    explicit SignatureCorpus(uint32_t seed)
+        : mRandom(seed)
+    {
+    }
+
+    std::string next()
+    {
+        static const std::vector<std::string> specifiers = {
+            "inline", "constexpr", "virtual", "explicit", "friend", "static", "__stdcall", "__cdecl",
+            "__thiscall", "__fastcall", "noexcept", "mutable", "const", "volatile", "[[nodiscard]]"
+        };
+        static const std::vector<std::string> types = {
+            "", "void", "int", "bool", "unsigned long long", "const std::string &", "std::string&&", "GAny",
+            "std::vector<int>", "std::map<std::string, int>", "Foo::Bar *", "const Foo&", "auto", "int*",
+            "std::function<void(int)>", "inline_t", "static_cast_t", "operator_t", "T"
+        };
+        static const std::vector<std::string> names = {
+            "get", "set", "Foo", "~Foo", "Bar", "value_", "operator", "operatorX", "my_operator", "size",
+            "operator==", "operator !=", "operator<=", "operator<=>", "operator >=", "operator<", "operator >",
+            "operator&&", "operator||", "operator+", "operator+=", "operator -", "operator->", "operator*",
+            "operator/", "operator%", "operator^", "operator&", "operator |", "operator~", "operator!",
+            "operator=", "operator()", "operator ()", "operator[]", "operator [ ]", "operator<<", "operator new",
+            "operator delete", "operator bool", "operator std::string", "operator Foo::Bar", "operator Foo::",
+            "operator ::Foo", "operator\tint", "operator  const char*", "Foo::operator==", "operator"
+        };
+        static const std::vector<std::string> spaces = {" ", " ", " ", "  ", "\t", " \t ", "\n"};
+
+        std::string head;
+        const auto pick = [&](const std::vector<std::string> &list) -> const std::string & {
+            return list[mRandom() % list.size()];
+        };
+        if (mRandom() % 3 == 0) {
+            head += pick(spaces);
+        }
+        for (uint32_t i = mRandom() % 3; i > 0; i--) {
+            head += pick(specifiers) + pick(spaces);
+        }
+        head += pick(types);
+        for (uint32_t i = mRandom() % 2; i > 0; i--) {
+            head += pick(spaces) + pick(specifiers);
+        }
+        head += pick(spaces) + pick(names);
+        if (mRandom() % 4 == 0) {
+            head += pick(spaces);
+        }
+        return head;
+    }
+
+    /**
+     * 随机拼出参数列表（含括号），默认值只出现在末尾的参数上，参数内部的空白已经规范化.
+     */
+    std::string nextArgs()
+    {
+        static const std::vector<std::string> types = {
+            "int", "bool", "unsigned long long", "const std::string &", "std::string&&", "GAny", "const GAny&",
+            "std::vector<int>", "std::map<std::string, int>", "Foo::Bar *", "int*", "const char *", "T",
+            "std::function<void(int)>", "std::function<bool(int, int)>", "std::pair<int, std::function<void()>>"
+        };
+        static const std::vector<std::string> names = {"", "a", "value_", "b2", "count"};
+        static const std::vector<std::string> defaults = {
+            "0", "\"\"", "{}", "nullptr", "true", "Foo::Bar()", "std::string(\"x\")", "max(1, 2)", "T{}",
+            "'('", "')'", "','", "'\\''", "\"a,b(\"", "\")\"", "\"<\"", "\"\\\")\""
+        };
+        static const std::vector<std::string> functionPointers = {"void (*fn)(int)", "int (Foo::*method)() const"};
+
+        const auto pick = [&](const std::vector<std::string> &list) -> const std::string & {
+            return list[mRandom() % list.size()];
+        };
+        const uint32_t count = mRandom() % 5;
+        const uint32_t firstDefault = count == 0 ? 0 : mRandom() % (count + 1);
+        std::string args = "(";
+        for (uint32_t i = 0; i < count; i++) {
+            if (i > 0) {
+                args += mRandom() % 2 ? ", " : ",";
+            }
+            if (mRandom() % 12 == 0) {
+                args += pick(functionPointers);
+            } else {
+                args += pick(types);
+                const std::string &name = pick(names);
+                if (!name.empty()) {
+                    args += " " + name;
+                }
+            }
+            if (i >= firstDefault) {
+                args += (mRandom() % 2 ? " = " : "=") + pick(defaults);
+            }
+        }
+        args += ")";
+        if (mRandom() % 3 == 0) {
+            args += " const";
+        }
+        return args;
+    }
+
+private:
+    std::mt19937 mRandom;
+};
+
+/**
+ * CppTypesInfoGen 的友元，直接调用签名解析的内部步骤.
+ */
+class SignatureCheck
+{
+public:
+    static size_t run(size_t count, uint32_t seed)
+    {
+        static const std::string CLASS_NAMES[] = {"Foo", "Bar"};
+
+        SignatureCorpus corpus(seed);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < count; i++) {
+            const std::string head = corpus.next();
+            const std::string &className = CLASS_NAMES[i % 2];
+            const std::string argList = corpus.nextArgs();
+            const std::string signature = head + argList;
+
+            // FuncSigInfo 的函数名和返回类型取自第一个 '(' 之前的部分，与两种实现一致
+            const auto expected = referenceExtractFunctionNameAndReturnType(referenceTrim(signature.substr(0, signature.find('('))), className);
+            const auto headExpected = referenceExtractFunctionNameAndReturnType(head, className);
+
+            TypesInfo typesInfo;
+            const FuncSigInfo info = CppTypesInfoGen::parseFunctionSignature(signature, className, typesInfo);
+            const auto headResult = CppTypesInfoGen::extractFunctionNameAndReturnType(head, className, *typesInfo.arena);
+
+            if (info.name != expected.first || info.retType != expected.second
+                || headResult.first != headExpected.first || headResult.second != headExpected.second) {
+                if (++mismatches <= 10) {
+                    fprintf(stderr, "mismatch: \"%s\"\n    regex: name=\"%s\" ret=\"%s\"\n    new:   name=\"%s\" ret=\"%s\"\n",
+                            signature.c_str(), expected.first.c_str(), expected.second.c_str(),
+                            std::string(info.name).c_str(), std::string(info.retType).c_str());
+                }
+                continue;
+            }
+
+            // 参数列表里有嵌套括号时按有意差异比较，其余与原实现逐项相同
+            const std::string_view params = std::string_view(argList).substr(1, argList.rfind(')') - 1);
+            const bool nestedParens = params.find_first_of("()'\"") != std::string_view::npos;
+            if (nestedParens) {
+                sNestedParenSignatures++;
+            }
+            const auto expectedArgs = referenceParseArguments(signature, nestedParens);
+            const std::span<const ArgInfo> args(typesInfo.args.data() + info.args.begin, info.args.count);
+            bool argsMatch = args.size() == expectedArgs.size();
+            for (size_t k = 0; argsMatch && k < args.size(); k++) {
+                argsMatch = args[k].type == expectedArgs[k].type && args[k].name == expectedArgs[k].name
+                            && (k >= info.requiredArgCount) == expectedArgs[k].hasDefault;
+            }
+            if (!argsMatch && ++mismatches <= 10) {
+                fprintf(stderr, "argument mismatch: \"%s\"\n", signature.c_str());
+                for (const auto &arg: expectedArgs) {
+                    fprintf(stderr, "    regex: type=\"%s\" name=\"%s\" default=%d\n", arg.type.c_str(), arg.name.c_str(), arg.hasDefault);
+                }
+                for (size_t k = 0; k < args.size(); k++) {
+                    fprintf(stderr, "    new:   type=\"%s\" name=\"%s\" default=%d\n", std::string(args[k].type).c_str(),
+                            std::string(args[k].name).c_str(), k >= info.requiredArgCount);
+                }
+            }
+        }
+        return mismatches;
+    }
+
+    static inline size_t sNestedParenSignatures = 0;
+};
+
+int main()
+{
+    constexpr size_t SIGNATURE_COUNT = 200000;
+
+    const size_t mismatches = SignatureCheck::run(SIGNATURE_COUNT, 20261017);
+    printf("signature check: %zu signatures (%zu with nested parentheses or literals in the arguments), %zu mismatches\n",
+           SIGNATURE_COUNT, SignatureCheck::sNestedParenSignatures, mismatches);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
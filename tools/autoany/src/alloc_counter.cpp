@@ -0,0 +1,31 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "alloc_counter.h"
+
+#include <atomic>
+
+
+static std::atomic<uint64_t> sAllocations{0};
+static std::atomic<bool> sEnabled{false};
+
+uint64_t AllocCounter::count()
+{
+    return sAllocations.load(std::memory_order_relaxed);
+}
+
+bool AllocCounter::enabled()
+{
+    return sEnabled.load(std::memory_order_relaxed);
+}
+
+void AllocCounter::enable()
+{
+    sEnabled.store(true, std::memory_order_relaxed);
+}
+
+void AllocCounter::add()
+{
+    sAllocations.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,32 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdint>
+
+
+/**
+ * 全局 operator new 的调用次数，用于 --stats 和基准测试.
+ * 只有 autoany-bench 替换了全局 new/delete（bench/alloc_hooks.cpp）并累加计数，
+ * autoany 本身使用默认的分配函数，此时 enabled() 为 false，不报告分配次数.
+ * 计数使用 relaxed 原子操作，开销可以忽略.
+ */
+class AllocCounter
+{
+public:
+    static uint64_t count();
+
+    static bool enabled();
+
+    /**
+     * 由替换的全局分配函数调用.
+     */
+    static void enable();
+
+    static void add();
+};
+
+#endif //ALLOC_COUNTER_H
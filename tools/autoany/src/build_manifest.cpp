@@ -0,0 +1,126 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "build_manifest.h"
+#include "output_file.h"
+
+#include <gx/gfile.h>
+
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+
+static constexpr const char *MANIFEST_MAGIC = "autoany-manifest 3";
+
+bool BuildManifest::load(const std::string &filePath)
+{
+    mVersion.clear();
+    mOptionsHash = 0;
+    mEntries.clear();
+
+    GFile file(filePath);
+    if (!file.exists() || !file.open(GFile::ReadOnly)) {
+        return false;
+    }
+    const std::string content = file.readAll().toStdString();
+    file.close();
+
+    std::istringstream input(content);
+    std::string line;
+    if (!std::getline(input, line) || line != MANIFEST_MAGIC) {
+        return false;
+    }
+
+    // version <string>
+    // options <hex>
+    // <hex hash>\t<weight>\t<output>\t<source>[\t<include_from>...]
+    while (std::getline(input, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        if (line.starts_with("version ")) {
+            mVersion = line.substr(8);
+            continue;
+        }
+        if (line.starts_with("options ")) {
+            mOptionsHash = std::strtoull(line.c_str() + 8, nullptr, 16);
+            continue;
+        }
+        const size_t tab1 = line.find('\t');
+        const size_t tab2 = tab1 == std::string::npos ? tab1 : line.find('\t', tab1 + 1);
+        const size_t tab3 = tab2 == std::string::npos ? tab2 : line.find('\t', tab2 + 1);
+        if (tab3 == std::string::npos) {
+            continue;
+        }
+        Entry entry;
+        entry.hash = std::strtoull(line.c_str(), nullptr, 16);
+        entry.weight = std::strtoull(line.c_str() + tab1 + 1, nullptr, 10);
+        entry.output = line.substr(tab2 + 1, tab3 - tab2 - 1);
+        size_t tab4 = line.find('\t', tab3 + 1);
+        const std::string source = line.substr(tab3 + 1, tab4 == std::string::npos ? tab4 : tab4 - tab3 - 1);
+        while (tab4 != std::string::npos) {
+            const size_t next = line.find('\t', tab4 + 1);
+            entry.includes.push_back(line.substr(tab4 + 1, next == std::string::npos ? next : next - tab4 - 1));
+            tab4 = next;
+        }
+        mEntries[source] = std::move(entry);
+    }
+
+    return true;
+}
+
+bool BuildManifest::save(const std::string &filePath) const
+{
+    std::stringstream os;
+    os << MANIFEST_MAGIC << "\n";
+    os << "version " << mVersion << "\n";
+    os << "options " << std::hex << std::setw(16) << std::setfill('0') << mOptionsHash << "\n";
+    for (const auto &[source, entry]: mEntries) {
+        os << std::hex << std::setw(16) << std::setfill('0') << entry.hash << std::dec
+            << "\t" << entry.weight << "\t" << entry.output << "\t" << source;
+        for (const auto &include: entry.includes) {
+            os << "\t" << include;
+        }
+        os << "\n";
+    }
+
+    return OutputFile::writeIfChanged(filePath, os.str()) != OutputFile::WriteResult::Failed;
+}
+
+bool BuildManifest::isCompatible(const std::string &version, uint64_t optionsHash) const
+{
+    return mVersion == version && mOptionsHash == optionsHash;
+}
+
+void BuildManifest::setKey(const std::string &version, uint64_t optionsHash)
+{
+    mVersion = version;
+    mOptionsHash = optionsHash;
+}
+
+const BuildManifest::Entry *BuildManifest::find(const std::string &source) const
+{
+    const auto it = mEntries.find(source);
+    if (it == mEntries.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void BuildManifest::set(const std::string &source, const Entry &entry)
+{
+    mEntries[source] = entry;
+}
+
+uint64_t BuildManifest::hashContent(std::string_view content, uint64_t seed)
+{
+    // FNV-1a 64
+    uint64_t hash = seed;
+    for (const char ch: content) {
+        hash ^= static_cast<uint8_t>(ch);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,64 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef BUILD_MANIFEST_H
+#define BUILD_MANIFEST_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * 记录上一次生成时每个输入头文件的内容哈希和输出文件，以及工具版本和生成选项.
+ * 保存在输出目录中，用于增量生成：哈希未变化的头文件跳过解析和代码生成.
+ */
+class BuildManifest
+{
+public:
+    static constexpr const char *FILE_NAME = "autoany.manifest";
+
+    struct Entry
+    {
+        uint64_t hash = 0;
+        uint64_t weight = 0; // 生成代码的估算实例化权重，用于分片
+        std::string output;  // 反射函数所在的输出文件名
+        std::vector<std::string> includes; // @include_from 引入的头文件，原样记录，用于写出 depfile
+    };
+
+public:
+    /**
+     * 从文件加载，文件不存在或格式不符时返回 false 且清单为空.
+     */
+    bool load(const std::string &filePath);
+
+    bool save(const std::string &filePath) const;
+
+    /**
+     * 版本或选项与当前运行不一致时，所有记录均视为失效.
+     */
+    bool isCompatible(const std::string &version, uint64_t optionsHash) const;
+
+    void setKey(const std::string &version, uint64_t optionsHash);
+
+    const Entry *find(const std::string &source) const;
+
+    void set(const std::string &source, const Entry &entry);
+
+    const std::map<std::string, Entry> &entries() const
+    {
+        return mEntries;
+    }
+
+    static uint64_t hashContent(std::string_view content, uint64_t seed = 0xcbf29ce484222325ULL);
+
+private:
+    std::string mVersion;
+    uint64_t mOptionsHash = 0;
+    std::map<std::string, Entry> mEntries;
+};
+
+#endif //BUILD_MANIFEST_H
@@ -3,25 +3,20 @@
 //
 
 #include "cpp_types_info_gen.h"
-#include <sstream>
-#include <iostream>
+#include "source_lexer.h"
+#include "perfect_hash_set.h"
+#include <algorithm>
 #include <cctype>
 #include <map>
-#include <deque>
-#include <regex>
 #include <unordered_set>
 #include <unordered_map>
 
 #include "gx/debug.h"
 
 
-static std::string trim(const std::string &str)
+static std::string_view trim(std::string_view str)
 {
-    const size_t first = str.find_first_not_of(" \t\r\n");
-    if (first == std::string::npos)
-        return "";
-    const size_t last = str.find_last_not_of(" \t\r\n");
-    return str.substr(first, last - first + 1);
+    return SourceLexer::trim(str);
 }
 
 static bool isIdentChar(char c)
@@ -29,380 +24,350 @@ static bool isIdentChar(char c)
     return std::isalnum(static_cast<unsigned char>(c)) || (c == '_');
 }
 
-static std::string unpackMacroSignature(const std::string &sig)
+static std::string_view unpackMacroSignature(std::string_view sig)
 {
     // 检查是否是 MACRO(xxx) 形式
     const size_t open = sig.find('(');
     const size_t close = sig.rfind(')');
-    if (open != std::string::npos && close != std::string::npos && open < close) {
-        const std::string prefix = sig.substr(0, open);
-        const std::string macro = trim(prefix);
+    if (open != std::string_view::npos && close != std::string_view::npos && open < close) {
+        const std::string_view macro = trim(sig.substr(0, open));
 
         // 简单白名单，防止误解包其他括号语法
-        static const std::unordered_set<std::string> knownMacros = {
+        static constexpr std::string_view knownMacros[] = {
             "GFX_API_FUNC",
             "GX_API_FUNC"
         };
 
-        if (knownMacros.contains(macro)) {
-            return trim(sig.substr(open + 1, close - open - 1));
+        for (const auto &knownMacro: knownMacros) {
+            if (macro == knownMacro) {
+                return trim(sig.substr(open + 1, close - open - 1));
+            }
         }
     }
     return sig;
 }
 
-//=======================================================
-
-TypesInfo CppTypesInfoGen::parse(const std::string &sourceCode)
+static constexpr PerfectHashSet<12, 32> FUNCTION_SPECIFIERS(std::array<std::string_view, 12>{
+    "inline",
+    "constexpr",
+    "virtual",
+    "explicit",
+    "friend",
+    "static",
+    "__stdcall",
+    "__cdecl",
+    "__thiscall",
+    "__fastcall",
+    "noexcept",
+    "mutable"
+});
+
+/**
+ * 注释标签名，顺序与 DocTag 一致（从 Ns 开始），最后的 brief、note 归为普通文档.
+ */
+static constexpr PerfectHashSet<29, 64> DOC_TAGS(std::array<std::string_view, 29>{
+    "ns",
+    "cpp_ns",
+    "include_from",
+    "using_ns",
+    "begin_scope",
+    "end_scope",
+    "class",
+    "struct",
+    "inherit",
+    "enum",
+    "enum_item",
+    "cast_to",
+    "cpp_name",
+    "def_enum",
+    "ref_code",
+    "constant",
+    "alias",
+    "property",
+    "pack_again",
+    "default_construct",
+    "construct",
+    "func",
+    "static_func",
+    "meta_func",
+    "property_get",
+    "property_set",
+    "func_sig",
+    "brief",
+    "note"
+});
+
+/**
+ * 返回与 open 处 '(' 匹配的 ')' 的位置，没有匹配时返回 npos.
+ * 字符串和字符字面量中的括号（例如默认值 '(' 或 "a,b("）不计入.
+ */
+static size_t findMatchingParen(std::string_view str, size_t open)
 {
-    const auto commentBlocks = extractCommentBlocks(sourceCode);
-    const auto parsedItems = parseCommentBlocks(commentBlocks);
-    auto classes = assembleTypesInfo(parsedItems);
-    return classes;
+    const SourceLexer lexer(str);
+    int level = 0;
+    for (size_t i = open; i < str.size(); i++) {
+        if (lexer.isLiteralStart(i)) {
+            i = lexer.skipLiteral(i) - 1;
+        } else if (str[i] == '(') {
+            ++level;
+        } else if (str[i] == ')' && --level == 0) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
 }
 
-std::string CppTypesInfoGen::stripDefaultValue(const std::string &param)
+/**
+ * 签名头中是否有独立的 static 说明符，返回类型从中去掉说明符后就看不到了.
+ */
+static bool hasStaticSpecifier(std::string_view head)
 {
-    const size_t eq = param.find('=');
-    if (eq != std::string::npos) {
-        return trim(param.substr(0, eq));
+    for (size_t pos = head.find("static"); pos != std::string_view::npos; pos = head.find("static", pos + 1)) {
+        const size_t end = pos + 6;
+        if ((pos == 0 || std::isspace(static_cast<unsigned char>(head[pos - 1])))
+            && (end == head.size() || std::isspace(static_cast<unsigned char>(head[end])))) {
+            return true;
+        }
     }
-    return trim(param);
+    return false;
 }
 
-std::string CppTypesInfoGen::normalizeFunctionSignature(const std::string &signature)
+/**
+ * 识别参数列表之后的 cv 与引用限定符，override、final、noexcept(...) 等其他说明符忽略，
+ * 遇到 "= 0"、"= default"、尾置返回类型或初始化列表时结束.
+ */
+static void parseFunctionQualifiers(std::string_view tail, FuncSigInfo &info)
 {
-    std::string result;
-    bool inSpace = false;
-    for (const char ch: signature) {
-        if (ch == '\n' || ch == '\r') {
-            if (!inSpace) {
-                result += ' ';
-                inSpace = true;
-            }
-        } else if (std::isspace(static_cast<unsigned char>(ch))) {
-            if (!inSpace) {
-                result += ' ';
-                inSpace = true;
+    static constexpr std::string_view CV_QUALIFIERS[] = {"", "const", "volatile", "const volatile"};
+
+    size_t cv = 0;
+    size_t pos = 0;
+    while (pos < tail.size()) {
+        const char c = tail[pos];
+        if (c == '=' || c == '-' || c == ':') {
+            break;
+        }
+        if (c == '&') {
+            info.refQualifier = pos + 1 < tail.size() && tail[pos + 1] == '&' ? "&&" : "&";
+            pos += info.refQualifier.size();
+            continue;
+        }
+        if (c == '(') {
+            const size_t close = findMatchingParen(tail, pos);
+            if (close == std::string_view::npos) {
+                break;
             }
-        } else {
-            result += ch;
-            inSpace = false;
+            pos = close + 1;
+            continue;
+        }
+        if (isIdentChar(c)) {
+            size_t end = pos;
+            while (end < tail.size() && isIdentChar(tail[end]))
+                ++end;
+            const std::string_view word = tail.substr(pos, end - pos);
+            if (word == "const") {
+                cv |= 1;
+            } else if (word == "volatile") {
+                cv |= 2;
+            }
+            pos = end;
+            continue;
         }
+        ++pos;
     }
-    const size_t first = result.find_first_not_of(' ');
-    const size_t last = result.find_last_not_of(' ');
-    if (first == std::string::npos)
-        return "";
-    return result.substr(first, last - first + 1);
+    info.cvQualifier = CV_QUALIFIERS[cv];
 }
 
-std::vector<FuncSigInfo> CppTypesInfoGen::generateOverloads(const FuncSigInfo &sig)
+/**
+ * 在 operator 关键字之后识别运算符名称，返回匹配长度，0 表示不是运算符.
+ * 候选按顺序匹配，前缀相同的长运算符排在前面（与原 opRegex 的候选顺序一致）.
+ */
+static size_t matchOperatorSymbol(std::string_view str)
 {
-    std::vector<FuncSigInfo> overloads;
-
-    const size_t paramCount = sig.argTypes.size();
-    size_t lastNonDefault = 0;
-
-    // 向后寻找第一个非默认参数
-    for (size_t i = paramCount; i-- > 0;) {
-        if (!sig.hasDefaultArg[i]) {
-            lastNonDefault = i + 1;
-            break;
+    static constexpr std::string_view symbols[] = {
+        "[]", "==", "!=", "<=", ">=", "<", ">", "&&", "||",
+        "+", "-", "*", "/", "%", "^", "&", "|", "~", "!", "=", "()"
+    };
+    for (const auto &sym: symbols) {
+        if (str.starts_with(sym)) {
+            return sym.size();
         }
     }
 
-    // 从 lastNonDefault 到 paramCount，生成重载版本
-    for (size_t i = lastNonDefault; i <= paramCount; ++i) {
-        FuncSigInfo alt;
-        alt.name = sig.name;
-        alt.retType = sig.retType;
-        alt.argTypes.assign(sig.argTypes.begin(), sig.argTypes.begin() + i);
-        alt.argsNames.assign(sig.argsNames.begin(), sig.argsNames.begin() + i);
-        alt.hasDefaultArg.assign(sig.hasDefaultArg.begin(), sig.hasDefaultArg.begin() + i);
-        overloads.push_back(std::move(alt));
+    // 转换运算符或 new/delete 等：\w+(::\w+)*
+    size_t len = 0;
+    while (len < str.size() && isIdentChar(str[len]))
+        ++len;
+    if (len == 0)
+        return 0;
+    while (len + 2 < str.size() && str[len] == ':' && str[len + 1] == ':' && isIdentChar(str[len + 2])) {
+        len += 2;
+        while (len < str.size() && isIdentChar(str[len]))
+            ++len;
     }
-
-    return overloads;
+    return len;
 }
 
-std::vector<std::string> CppTypesInfoGen::extractCommentBlocks(const std::string &source)
-{
-    std::vector<std::string> comments;
-    std::istringstream input(source);
-    std::string line;
-    bool inBlock = false;
-    bool isDocComment = false;
-    std::string current;
-
-    auto cleanCommentLine = [](const std::string &l) -> std::string {
-        std::string trimmed = trim(l);
-        if (trimmed.starts_with("*")) {
-            trimmed = trimmed.substr(1);
-            trimmed = trim(trimmed);
-        }
-        return trimmed;
-    };
-
-    while (std::getline(input, line)) {
-        std::string trimmed = trim(line);
+//=======================================================
 
-        if (!inBlock) {
-            for (const char ch: trimmed) {
-                if (ch == '{') {
-                    comments.emplace_back("@begin_scope");
-                } else if (ch == '}') {
-                    comments.emplace_back("@end_scope");
-                }
-            }
+TypesInfo CppTypesInfoGen::parse(std::string_view sourceCode)
+{
+    // 模型通常比源码小，按源码大小预留首块，多数头文件只需一次分配
+    TypesInfo typesInfo(sourceCode.size() / 2 + 4096);
+    ArenaVector<TagItem> tags(typesInfo.arena->resource());
+    const auto commentBlocks = extractCommentBlocks(sourceCode, *typesInfo.arena);
+    typesInfo.commentBlockCount = static_cast<uint32_t>(std::count_if(commentBlocks.begin(), commentBlocks.end(), [](const CommentBlock &block) {
+        return block.kind == CommentBlock::Kind::Doc;
+    }));
+    const auto parsedItems = parseCommentBlocks(commentBlocks, tags);
+    assembleTypesInfo(parsedItems, tags, typesInfo);
+    resolveAllTypesFullQualified(typesInfo);
+    return typesInfo;
+}
 
-            if (trimmed.starts_with("/*")) {
-                inBlock = true;
-                isDocComment = true;
-                current.clear();
-                if (trimmed.size() > 3) {
-                    std::string rest = trimmed.substr(3);
-                    if (rest.find("*/") != std::string::npos) {
-                        current += cleanCommentLine(rest.substr(0, rest.find("*/"))) + "\n";
-                        inBlock = false;
-                    } else {
-                        current += cleanCommentLine(rest) + "\n";
-                    }
-                }
-            } else if (trimmed.starts_with("///")) {
-                inBlock = true;
-                isDocComment = false;
-                current.clear();
-                current += trimmed.substr(3) + "\n";
-            }
-        } else {
-            if (isDocComment) {
-                size_t pos = trimmed.find("*/");
-                if (pos != std::string::npos) {
-                    current += cleanCommentLine(trimmed.substr(0, pos)) + "\n";
-                    inBlock = false;
-                } else {
-                    current += cleanCommentLine(trimmed) + "\n";
-                }
-            } else {
-                if (trimmed.starts_with("///")) {
-                    current += trimmed.substr(3) + "\n";
-                } else {
-                    inBlock = false;
-                    // current已经收集完所有 /// 注释行了，准备提取函数签名
-                    bool needFuncSig = current.find("@construct") != std::string::npos ||
-                                       current.find("@func") != std::string::npos ||
-                                       current.find("@static_func") != std::string::npos ||
-                                       current.find("@meta_func") != std::string::npos;
-
-                    bool hasBeginScope = false;
-                    bool hasEndScope = false;
-                    if (needFuncSig) {
-                        std::string funcSig;
-                        funcSig += trimmed + " "; // 当前行（不是///）也属于函数签名一部分
-                        if (funcSig.find('{') != std::string::npos) {
-                            hasBeginScope = true;
-                        }
-                        if (funcSig.find('}') != std::string::npos) {
-                            hasEndScope = true;
-                        }
+CppTypesInfoGen::DocTag CppTypesInfoGen::findDocTag(std::string_view name)
+{
+    if (name.empty()) {
+        return DocTag::Doc;
+    }
+    const int index = DOC_TAGS.indexOf(name);
+    if (index < 0) {
+        return DocTag::Unknown;
+    }
+    if (index >= static_cast<int>(DocTag::Unknown) - 1) {
+        return DocTag::Doc;
+    }
+    return static_cast<DocTag>(index + 1);
+}
 
-                        if (funcSig.find(';') == std::string::npos ||
-                            funcSig.find('{') == std::string::npos) {
-                            while (std::getline(input, line)) {
-                                std::string codeLine = trim(line);
-                                if (codeLine.empty())
-                                    continue;
-                                if (codeLine.starts_with("///") || codeLine.starts_with("/**"))
-                                    break;
-                                funcSig += codeLine + " ";
-                                if (codeLine.find(';') != std::string::npos ||
-                                    codeLine.find('{') != std::string::npos) {
-                                    if (codeLine.find('{') != std::string::npos) {
-                                        hasBeginScope = true;
-                                    }
-                                    if (codeLine.find('}') != std::string::npos) {
-                                        hasEndScope = true;
-                                    }
-                                    break;
-                                }
-                            }
-                        }
+std::string_view CppTypesInfoGen::stripDefaultValue(std::string_view param)
+{
+    const size_t eq = param.find('=');
+    if (eq != std::string_view::npos) {
+        return trim(param.substr(0, eq));
+    }
+    return trim(param);
+}
 
-                        funcSig = normalizeFunctionSignature(funcSig);
-                        if (!funcSig.empty()) {
-                            current += "@func_sig " + funcSig + "\n";
-                        }
-                    } else {
-                        for (const char ch: trimmed) {
-                            if (ch == '{') {
-                                hasBeginScope = true;
-                            } else if (ch == '}') {
-                                hasEndScope = true;
-                            }
-                        }
-                    }
+void CppTypesInfoGen::generateOverloads(ModelIndex sig, const TypesInfo &typesInfo, ArenaVector<OverloadInfo> &overloads)
+{
+    // 从最后一个非默认参数到全部参数，每个参数个数对应一个重载
+    const FuncSigInfo &info = typesInfo.signatures[sig];
+    for (uint32_t i = info.requiredArgCount; i <= info.args.count; ++i) {
+        overloads.push_back({sig, i});
+    }
+}
 
-                    comments.push_back(current);
-                    current.clear();
+ArenaVector<CppTypesInfoGen::CommentBlock> CppTypesInfoGen::extractCommentBlocks(std::string_view source, ParseArena &arena)
+{
+    ArenaVector<CommentBlock> comments(arena.resource());
+    SourceLexer lexer(source);
+    SourceToken token;
+    std::string sigBuffer;
 
-                    if (hasBeginScope) {
-                        comments.emplace_back("@begin_scope");
-                    }
-                    if (hasEndScope) {
-                        comments.emplace_back("@end_scope");
-                    }
-                }
+    while (lexer.next(token)) {
+        switch (token.type) {
+            case SourceToken::Type::CommentBlock: {
+                comments.push_back({CommentBlock::Kind::Doc, lexer.text(token), {}});
             }
-
-            // doc注释 /** */ 情况，注释结束后也要处理函数签名
-            if (!inBlock && isDocComment && !current.empty()) {
-                bool needFuncSig = current.find("@construct") != std::string::npos ||
-                                   current.find("@func") != std::string::npos ||
-                                   current.find("@static_func") != std::string::npos ||
-                                   current.find("@meta_func") != std::string::npos;
-
-                bool hasBeginScope = false;
-                bool hasEndScope = false;
-                if (needFuncSig) {
-                    std::string funcSig;
-                    while (std::getline(input, line)) {
-                        std::string codeLine = trim(line);
-                        if (codeLine.empty())
-                            continue;
-                        if (codeLine.starts_with("///") || codeLine.starts_with("/**"))
-                            break;
-                        funcSig += codeLine + " ";
-                        if (codeLine.find(';') != std::string::npos ||
-                            codeLine.find('{') != std::string::npos) {
-                            if (codeLine.find('{') != std::string::npos) {
-                                hasBeginScope = true;
-                            }
-                            if (codeLine.find('}') != std::string::npos) {
-                                hasEndScope = true;
-                            }
-                            break;
-                        }
-                    }
-                    funcSig = normalizeFunctionSignature(funcSig);
-                    if (!funcSig.empty()) {
-                        current += "@func_sig " + funcSig + "\n";
-                    }
-                }
-
-                comments.push_back(current);
-                current.clear();
-
-                if (hasBeginScope) {
-                    comments.emplace_back("@begin_scope");
-                }
-                if (hasEndScope) {
-                    comments.emplace_back("@end_scope");
-                }
+            break;
+            case SourceToken::Type::Signature: {
+                // 签名总是紧跟在它所属的注释块之后；只有需要规范化时才生成新的字符串
+                const std::string_view rawSig = lexer.text(token);
+                sigBuffer.clear();
+                SourceLexer::appendCodeText(sigBuffer, rawSig);
+                comments.back().signature = sigBuffer == rawSig ? rawSig : arena.intern(sigBuffer);
+            }
+            break;
+            case SourceToken::Type::ScopeOpen: {
+                comments.push_back({CommentBlock::Kind::BeginScope, {}, {}});
             }
+            break;
+            case SourceToken::Type::ScopeClose: {
+                comments.push_back({CommentBlock::Kind::EndScope, {}, {}});
+            }
+            break;
         }
     }
 
     return comments;
 }
 
-std::vector<CppTypesInfoGen::TagItem> CppTypesInfoGen::parseDocComment(const std::string &commentText)
+void CppTypesInfoGen::parseDocComment(std::string_view commentText, ArenaVector<TagItem> &tags)
 {
-    std::vector<TagItem> items;
-    std::istringstream input(commentText);
-    std::string line;
-    TagItem currentItem;
-
-    while (std::getline(input, line)) {
-        std::string trimmedLine = trim(line);
-        if (trimmedLine.empty())
-            continue;
+    SourceLexer::forEachCommentLine(commentText, [&](std::string_view line) {
+        if (line.empty())
+            return;
 
-        if (trimmedLine[0] == '@') {
-            if (!currentItem.tag.empty() || !currentItem.value.empty()) {
-                items.push_back(currentItem);
-                currentItem = TagItem();
-            }
-            size_t spacePos = trimmedLine.find(' ');
-            if (spacePos != std::string::npos) {
-                currentItem.tag = trimmedLine.substr(1, spacePos - 1);
-                currentItem.value = trimmedLine.substr(spacePos + 1);
-            } else {
-                currentItem.tag = trimmedLine.substr(1);
-                currentItem.value = "";
+        if (line[0] == '@') {
+            const size_t spacePos = line.find(' ');
+            if (spacePos != std::string_view::npos) {
+                tags.push_back({findDocTag(line.substr(1, spacePos - 1)), line.substr(spacePos + 1)});
+            } else if (line.size() > 1) {
+                tags.push_back({findDocTag(line.substr(1)), {}});
             }
         } else {
-            if (!currentItem.tag.empty() || !currentItem.value.empty()) {
-                items.push_back(currentItem);
-                currentItem = TagItem();
-            }
-            currentItem.tag = "";
-            currentItem.value = trimmedLine;
+            tags.push_back({DocTag::Doc, line});
         }
-    }
-
-    if (!currentItem.tag.empty() || !currentItem.value.empty()) {
-        items.push_back(currentItem);
-    }
-    return items;
+    });
 }
 
-std::vector<CppTypesInfoGen::ParsedItem> CppTypesInfoGen::parseCommentBlocks(const std::vector<std::string> &commentBlocks)
+ArenaVector<CppTypesInfoGen::ParsedItem> CppTypesInfoGen::parseCommentBlocks(const ArenaVector<CommentBlock> &commentBlocks, ArenaVector<TagItem> &tags)
 {
-    std::vector<ParsedItem> parsedItems;
+    ArenaVector<ParsedItem> parsedItems(tags.get_allocator());
+    parsedItems.reserve(commentBlocks.size());
 
     for (const auto &block: commentBlocks) {
-        ParsedItem item;
-        item.tags = parseDocComment(block);
-        parsedItems.push_back(item);
+        ParsedItem &item = parsedItems.emplace_back();
+        item.tags.begin = static_cast<uint32_t>(tags.size());
+        switch (block.kind) {
+            case CommentBlock::Kind::BeginScope:
+                tags.push_back({DocTag::BeginScope, {}});
+                break;
+            case CommentBlock::Kind::EndScope:
+                tags.push_back({DocTag::EndScope, {}});
+                break;
+            case CommentBlock::Kind::Doc:
+                parseDocComment(block.text, tags);
+                item.funcSig = block.signature;
+                break;
+        }
+        item.tags.count = static_cast<uint32_t>(tags.size()) - item.tags.begin;
     }
 
     return parsedItems;
 }
 
-FuncSigInfo CppTypesInfoGen::parseFunctionSignature(const std::string &signature, const std::string &className)
+FuncSigInfo CppTypesInfoGen::parseFunctionSignature(std::string_view signature, std::string_view className, TypesInfo &typesInfo)
 {
     FuncSigInfo info;
-    std::string sig = normalizeFunctionSignature(signature);
-    sig = unpackMacroSignature(sig);
+    info.args.begin = static_cast<uint32_t>(typesInfo.args.size());
+    const std::string_view sig = unpackMacroSignature(signature);
 
+    // 括号不配对时按第一个 ')' 截断参数列表，与匹配之前的行为一致
     size_t lparen = sig.find('(');
-    size_t rparen = sig.find(')');
-    if (lparen == std::string::npos || rparen == std::string::npos || rparen < lparen)
+    size_t rparen = lparen == std::string_view::npos ? lparen : findMatchingParen(sig, lparen);
+    if (rparen == std::string_view::npos)
+        rparen = sig.find(')', lparen);
+    if (lparen == std::string_view::npos || rparen == std::string_view::npos || rparen < lparen)
         return info;
 
-    std::string beforeParen = trim(sig.substr(0, lparen));
-    std::string insideParen = sig.substr(lparen + 1, rparen - lparen - 1);
+    std::string_view beforeParen = trim(sig.substr(0, lparen));
+    std::string_view insideParen = sig.substr(lparen + 1, rparen - lparen - 1);
 
-    auto [name, ret] = extractFunctionNameAndReturnType(beforeParen, className);
+    auto [name, ret] = extractFunctionNameAndReturnType(beforeParen, className, *typesInfo.arena);
     info.name = name;
     info.retType = ret;
+    info.isStaticMember = hasStaticSpecifier(beforeParen);
+    parseFunctionQualifiers(sig.substr(rparen + 1), info);
 
-    // 处理参数
-    std::vector<std::string> params;
-    std::string currentParam;
-    int parenLevel = 0;
-    for (char c: insideParen) {
-        if (c == ',' && parenLevel == 0) {
-            params.push_back(trim(currentParam));
-            currentParam.clear();
-        } else {
-            if (c == '<')
-                ++parenLevel;
-            if (c == '>')
-                --parenLevel;
-            currentParam += c;
-        }
-    }
-    if (!currentParam.empty())
-        params.push_back(trim(currentParam));
-
+    // 处理参数，直接追加到参数数组
     int unnamedCount = 0;
-    for (auto &p: params) {
-        bool hasDefault = p.find('=') != std::string::npos;
+    auto addParam = [&](std::string_view p) {
+        bool hasDefault = p.find('=') != std::string_view::npos;
         p = stripDefaultValue(p);
         if (p.empty())
-            continue;
+            return;
 
         size_t nameEnd = p.size();
         while (nameEnd > 0 && !isIdentChar(p[nameEnd - 1]))
@@ -411,70 +376,137 @@ FuncSigInfo CppTypesInfoGen::parseFunctionSignature(const std::string &signature
         while (nameStart > 0 && isIdentChar(p[nameStart - 1]))
             --nameStart;
 
-        std::string varName = p.substr(nameStart, nameEnd - nameStart);
-        std::string typePart = trim(p.substr(0, nameStart));
+        std::string_view varName = p.substr(nameStart, nameEnd - nameStart);
+        std::string_view typePart = trim(p.substr(0, nameStart));
 
         if (varName.empty()) {
-            varName = "arg" + std::to_string(unnamedCount++);
+            varName = typesInfo.arena->intern("arg" + std::to_string(unnamedCount++));
+        }
+
+        typesInfo.args.push_back({typePart, varName});
+        info.args.count++;
+        if (!hasDefault) {
+            info.requiredArgCount = info.args.count;
         }
+    };
 
-        info.argTypes.push_back(typePart);
-        info.argsNames.push_back(varName);
-        info.hasDefaultArg.push_back(hasDefault);
+    const SourceLexer paramLexer(insideParen);
+    size_t paramStart = 0;
+    int parenLevel = 0;
+    for (size_t i = 0; i < insideParen.size(); i++) {
+        const char c = insideParen[i];
+        if (paramLexer.isLiteralStart(i)) {
+            i = paramLexer.skipLiteral(i) - 1;
+        } else if (c == ',' && parenLevel == 0) {
+            addParam(trim(insideParen.substr(paramStart, i - paramStart)));
+            paramStart = i + 1;
+        } else {
+            if (c == '<' || c == '(')
+                ++parenLevel;
+            if (c == '>' || c == ')')
+                --parenLevel;
+        }
     }
+    if (paramStart < insideParen.size())
+        addParam(trim(insideParen.substr(paramStart)));
 
     return info;
 }
 
-TypesInfo CppTypesInfoGen::assembleTypesInfo(const std::vector<ParsedItem> &parsedItems)
+void CppTypesInfoGen::assembleTypesInfo(const ArenaVector<ParsedItem> &parsedItems, const ArenaVector<TagItem> &tags, TypesInfo &typesInfo)
 {
-    std::vector<std::shared_ptr<ClassInfo> > classes;
-    std::vector<std::shared_ptr<EnumClassInfo>> enumClasses;
-    std::vector<ClassInfo *> classStack;
-    std::vector<std::string> scopeStack;
-    std::map<std::string, PropertyInfo *> propertyMap;
-    std::string pendingScopeType;
+    ParseArena &arena = *typesInfo.arena;
+    std::pmr::memory_resource *resource = arena.resource();
+    ArenaVector<ModelIndex> classStack(resource);
+    ArenaVector<std::string_view> scopeStack(resource);
+    std::pmr::map<std::string_view, ModelIndex> propertyMap(resource);
+    std::string_view pendingScopeType;
 
-    TypesInfo typesInfo{};
+    std::string_view globalNS;
+    std::string docBuffer;
 
-    std::string globalNS;
+    auto addEnumItems = [&](std::span<const TagItem> itemTags) {
+        ModelRange range{static_cast<uint32_t>(typesInfo.enumItems.size()), 0};
+        for (const auto &t: itemTags) {
+            if (t.tag == DocTag::EnumItem) {
+                typesInfo.enumItems.push_back(t.value);
+                range.count++;
+            }
+        }
+        return range;
+    };
+
+    auto addFunc = [&](std::string_view name, std::string_view doc, bool isStatic, bool isMetaFunc, ArenaVector<OverloadInfo> &&overloads) {
+        FuncInfo &func = typesInfo.funcs.emplace_back(resource);
+        func.name = name;
+        func.doc = doc;
+        func.isStatic = isStatic;
+        func.isMetaFunc = isMetaFunc;
+        func.overloads = std::move(overloads);
+        return static_cast<ModelIndex>(typesInfo.funcs.size() - 1);
+    };
+
+    auto addProperty = [&](ClassInfo &cls, std::string_view name) {
+        const auto index = static_cast<ModelIndex>(typesInfo.properties.size());
+        PropertyInfo &property = typesInfo.properties.emplace_back();
+        property.name = name;
+        cls.properties.push_back(index);
+        propertyMap[name] = index;
+        return index;
+    };
 
     for (const auto &item: parsedItems) {
-        std::string currentDoc;
-        std::map<std::string, std::string> tagMap;
-        for (const auto &tag: item.tags) {
-            tagMap[tag.tag] = tag.value;
-            if (tag.tag.empty() || tag.tag == "brief" || tag.tag == "note") {
-                currentDoc += tag.value + "\n";
+        const std::span<const TagItem> itemTags(tags.data() + item.tags.begin, item.tags.count);
+
+        // 只有一行文档时直接引用源码，多行才需要拼接
+        std::string_view currentDoc;
+        size_t docParts = 0;
+        TagSet tagSet;
+        for (const auto &tag: itemTags) {
+            tagSet.set(tag.tag, tag.value);
+            if (tag.tag == DocTag::Doc) {
+                if (docParts == 0) {
+                    currentDoc = tag.value;
+                } else {
+                    if (docParts == 1) {
+                        docBuffer.assign(currentDoc);
+                    }
+                    docBuffer.push_back('\n');
+                    docBuffer.append(tag.value);
+                }
+                docParts++;
             }
         }
-        if (!currentDoc.empty() && currentDoc.back() == '\n') {
-            currentDoc = currentDoc.substr(0, currentDoc.size() - 1);
+        if (docParts > 1) {
+            currentDoc = arena.intern(docBuffer);
+        }
+        if (!item.funcSig.empty()) {
+            tagSet.set(DocTag::FuncSig, item.funcSig);
         }
 
-        if (tagMap.contains("ns") && scopeStack.empty()) {
-            globalNS = tagMap["ns"];
+        if (tagSet.has(DocTag::Ns) && scopeStack.empty()) {
+            globalNS = tagSet[DocTag::Ns];
         }
 
-        if (tagMap.contains("cpp_ns") && scopeStack.empty()) {
-            typesInfo.cppNamespace = tagMap["cpp_ns"];
+        if (tagSet.has(DocTag::CppNs) && scopeStack.empty()) {
+            typesInfo.cppNamespace = tagSet[DocTag::CppNs];
         }
 
-        if (tagMap.contains("include_from")) {
-            std::string v = tagMap["include_from"];
+        if (tagSet.has(DocTag::IncludeFrom)) {
+            std::string_view v = tagSet[DocTag::IncludeFrom];
             if (!v.empty()) {
                 typesInfo.includeFromSet.insert(v);
             }
             continue;
         }
 
-        if (tagMap.contains("begin_scope")) {
+        if (tagSet.has(DocTag::BeginScope)) {
             scopeStack.push_back(pendingScopeType.empty() ? "unknown" : pendingScopeType);
-            pendingScopeType.clear();
+            pendingScopeType = {};
             continue;
         }
 
-        if (tagMap.contains("end_scope")) {
+        if (tagSet.has(DocTag::EndScope)) {
             if (!scopeStack.empty()) {
                 if (scopeStack.back() == "class" && !classStack.empty()) {
                     classStack.pop_back();
@@ -484,9 +516,9 @@ TypesInfo CppTypesInfoGen::assembleTypesInfo(const std::vector<ParsedItem> &pars
             continue;
         }
 
-        if (tagMap.contains("using_ns")) {
-            for (const auto &t: item.tags) {
-                if (t.tag == "using_ns") {
+        if (tagSet.has(DocTag::UsingNs)) {
+            for (const auto &t: itemTags) {
+                if (t.tag == DocTag::UsingNs) {
                     typesInfo.usingNameSpaces.push_back(t.value);
                 }
             }
@@ -494,76 +526,69 @@ TypesInfo CppTypesInfoGen::assembleTypesInfo(const std::vector<ParsedItem> &pars
             continue;
         }
 
-        if (tagMap.contains("def_enum")) {
-            auto enumInfo = std::make_shared<EnumClassInfo>();
-            enumInfo->isDefEnum = true;
-            enumInfo->name = tagMap["def_enum"];
-            enumInfo->doc = currentDoc;
-            enumInfo->ns = globalNS;
-            if (tagMap.contains("ns")) {
-                enumInfo->ns = tagMap["ns"];
+        if (tagSet.has(DocTag::DefEnum)) {
+            EnumClassInfo &enumInfo = typesInfo.enumClasses.emplace_back();
+            enumInfo.isDefEnum = true;
+            enumInfo.name = tagSet[DocTag::DefEnum];
+            enumInfo.doc = currentDoc;
+            enumInfo.ns = globalNS;
+            if (tagSet.has(DocTag::Ns)) {
+                enumInfo.ns = tagSet[DocTag::Ns];
             }
-            if (tagMap.contains("cpp_name")) {
-                enumInfo->cppName = tagMap["cpp_name"];
+            if (tagSet.has(DocTag::CppName)) {
+                enumInfo.cppName = tagSet[DocTag::CppName];
             } else {
-                enumInfo->cppName = enumInfo->name;
+                enumInfo.cppName = enumInfo.name;
             }
-
-            enumClasses.push_back(enumInfo);
             continue;
         }
 
-        if (tagMap.contains("enum") && scopeStack.empty()) {
-            auto enumInfo = std::make_shared<EnumClassInfo>();
-            enumInfo->name = tagMap["enum"];
-            if (tagMap.contains("cpp_name")) {
-                enumInfo->cppName = tagMap["cpp_name"];
+        if (tagSet.has(DocTag::Enum) && scopeStack.empty()) {
+            EnumClassInfo &enumInfo = typesInfo.enumClasses.emplace_back();
+            enumInfo.name = tagSet[DocTag::Enum];
+            if (tagSet.has(DocTag::CppName)) {
+                enumInfo.cppName = tagSet[DocTag::CppName];
             } else {
-                enumInfo->cppName = enumInfo->name;
+                enumInfo.cppName = enumInfo.name;
             }
-            enumInfo->ns = globalNS;
-            if (tagMap.contains("ns")) {
-                enumInfo->ns = tagMap["ns"];
+            enumInfo.ns = globalNS;
+            if (tagSet.has(DocTag::Ns)) {
+                enumInfo.ns = tagSet[DocTag::Ns];
             }
-            enumInfo->doc = currentDoc;
-            if (tagMap.contains("cast_to"))
-                enumInfo->castTo = tagMap["cast_to"];
-            for (const auto &t: item.tags) {
-                if (t.tag == "enum_item")
-                    enumInfo->enumItems.push_back(t.value);
-            }
-            enumClasses.push_back(enumInfo);
+            enumInfo.doc = currentDoc;
+            if (tagSet.has(DocTag::CastTo))
+                enumInfo.castTo = tagSet[DocTag::CastTo];
+            enumInfo.enumItems = addEnumItems(itemTags);
             continue;
         }
 
-        if (tagMap.contains("ref_code")) {
+        if (tagSet.has(DocTag::RefCode)) {
             typesInfo.customRefCode = currentDoc;
             continue;
         }
 
-        if (tagMap.contains("class") || tagMap.contains("struct")) {
+        if (tagSet.has(DocTag::Class) || tagSet.has(DocTag::Struct)) {
             pendingScopeType = "class";
 
-            auto cls = std::make_shared<ClassInfo>();
-            cls->name = tagMap.contains("class") ? tagMap["class"] : tagMap["struct"];
-            cls->doc = currentDoc;
+            const auto classIndex = static_cast<ModelIndex>(typesInfo.classes.size());
+            ClassInfo &cls = typesInfo.classes.emplace_back(resource);
+            cls.name = tagSet.has(DocTag::Class) ? tagSet[DocTag::Class] : tagSet[DocTag::Struct];
+            cls.doc = currentDoc;
 
-            cls->ns = globalNS;
-            if (tagMap.contains("ns")) {
-                cls->ns = tagMap["ns"];
+            cls.ns = globalNS;
+            if (tagSet.has(DocTag::Ns)) {
+                cls.ns = tagSet[DocTag::Ns];
             }
 
-            if (tagMap.contains("cpp_name")) {
-                cls->cppName = tagMap["cpp_name"];
+            if (tagSet.has(DocTag::CppName)) {
+                cls.cppName = tagSet[DocTag::CppName];
             } else {
-                cls->cppName = cls->name;
+                cls.cppName = cls.name;
             }
 
-            if (tagMap.contains("inherit")) {
-                for (const auto &t: item.tags) {
-                    if (t.tag == "inherit") {
-                        cls->parents.push_back(t.value);
-                    }
+            for (const auto &t: itemTags) {
+                if (t.tag == DocTag::Inherit) {
+                    cls.parents.push_back(t.value);
                 }
             }
 
@@ -571,218 +596,207 @@ TypesInfo CppTypesInfoGen::assembleTypesInfo(const std::vector<ParsedItem> &pars
                 std::string outer;
                 std::string outerCpp;
                 for (size_t i = 0; i < classStack.size(); ++i) {
+                    const ClassInfo &outerClass = typesInfo.classes[classStack[i]];
                     if (i > 0) {
                         outer += ".";
                         outerCpp += "::";
                     }
-                    outer += classStack[i]->name;
-                    outerCpp += classStack[i]->cppName;
+                    outer += outerClass.name;
+                    outerCpp += outerClass.cppName;
                 }
-                cls->outerClass = outer;
-                cls->outerCppName = outerCpp;
+                cls.outerClass = arena.intern(outer);
+                cls.outerCppName = arena.intern(outerCpp);
             }
 
-            classes.push_back(cls);
-            ClassInfo *currentClass = cls.get();
-            classStack.push_back(currentClass);
+            classStack.push_back(classIndex);
             propertyMap.clear();
             continue;
         }
 
         if (classStack.empty())
             continue;
-        ClassInfo *currentClass = classStack.back();
+        ClassInfo &currentClass = typesInfo.classes[classStack.back()];
 
-        if (tagMap.contains("constant")) {
-            auto constantInfo = std::make_shared<ConstantInfo>();
-            constantInfo->name = tagMap["constant"];
-            currentClass->constants.push_back(constantInfo);
+        if (tagSet.has(DocTag::Constant)) {
+            currentClass.constants.push_back({tagSet[DocTag::Constant]});
         }
 
-        if (tagMap.contains("alias")) {
-            GString alias = tagMap["alias"];
-            auto splits = alias.split('=');
-            if (splits.size() == 2) {
-                std::string newName = trim(splits[0].toStdString());
-                std::string oldName = trim(splits[1].toStdString());
+        if (tagSet.has(DocTag::Alias)) {
+            const std::string_view alias = tagSet[DocTag::Alias];
+            const size_t eq = alias.find('=');
+            if (eq != std::string_view::npos && alias.find('=', eq + 1) == std::string_view::npos) {
+                const std::string_view newName = trim(alias.substr(0, eq));
+                const std::string_view oldName = trim(alias.substr(eq + 1));
 
-                currentClass->aliases[newName] = oldName;
+                auto it = std::find_if(currentClass.aliases.begin(), currentClass.aliases.end(), [&](const AliasInfo &a) {
+                    return a.newName == newName;
+                });
+                if (it != currentClass.aliases.end()) {
+                    it->oldName = oldName;
+                } else {
+                    currentClass.aliases.push_back({newName, oldName});
+                }
             }
         }
 
-        if (tagMap.contains("enum")) {
-            auto enumInfo = std::make_shared<EnumInfo>();
-            enumInfo->name = tagMap["enum"];
-            enumInfo->doc = currentDoc;
-            if (tagMap.contains("cpp_name")) {
-                enumInfo->cppName = tagMap["cpp_name"];
+        if (tagSet.has(DocTag::Enum)) {
+            EnumInfo &enumInfo = typesInfo.enums.emplace_back();
+            enumInfo.name = tagSet[DocTag::Enum];
+            enumInfo.doc = currentDoc;
+            if (tagSet.has(DocTag::CppName)) {
+                enumInfo.cppName = tagSet[DocTag::CppName];
             } else {
-                enumInfo->cppName = enumInfo->name;
-            }
-            if (tagMap.contains("cast_to"))
-                enumInfo->castTo = tagMap["cast_to"];
-            for (const auto &t: item.tags) {
-                if (t.tag == "enum_item")
-                    enumInfo->enumItems.push_back(t.value);
+                enumInfo.cppName = enumInfo.name;
             }
-            currentClass->enums.push_back(enumInfo);
+            if (tagSet.has(DocTag::CastTo))
+                enumInfo.castTo = tagSet[DocTag::CastTo];
+            enumInfo.enumItems = addEnumItems(itemTags);
+            currentClass.enums.push_back(static_cast<ModelIndex>(typesInfo.enums.size() - 1));
         }
 
-        if (tagMap.contains("property")) {
-            auto prop = std::make_shared<PropertyInfo>();
-            prop->name = tagMap["property"];
-            prop->doc = currentDoc;
+        if (tagSet.has(DocTag::Property)) {
+            PropertyInfo &prop = typesInfo.properties[addProperty(currentClass, tagSet[DocTag::Property])];
+            prop.doc = currentDoc;
 
-            if (tagMap.contains("pack_again")) {
-                prop->packAgain = true;
-                prop->type = tagMap["pack_again"];
+            if (tagSet.has(DocTag::PackAgain)) {
+                prop.packAgain = true;
+                prop.type = tagSet[DocTag::PackAgain];
             }
-
-            currentClass->properties.push_back(prop);
-            propertyMap[prop->name] = prop.get();
         }
 
-        if (tagMap.contains("default_construct")) {
-            auto func = std::make_shared<FuncInfo>();
-            func->overloads.push_back({});
-            currentClass->constructs.push_back(func);
+        if (tagSet.has(DocTag::DefaultConstruct)) {
+            const auto sig = static_cast<ModelIndex>(typesInfo.signatures.size());
+            typesInfo.signatures.push_back({});
+            ArenaVector<OverloadInfo> overloads(resource);
+            overloads.push_back({sig, 0});
+            currentClass.constructs.push_back(addFunc({}, {}, false, false, std::move(overloads)));
         }
 
-        if (tagMap.contains("construct") || tagMap.contains("func") || tagMap.contains("static_func") || tagMap.contains("meta_func")) {
-            auto func = std::make_shared<FuncInfo>();
-            func->doc = currentDoc;
+        if (tagSet.has(DocTag::Construct) || tagSet.has(DocTag::Func) || tagSet.has(DocTag::StaticFunc) || tagSet.has(DocTag::MetaFunc)) {
+            std::string_view name;
+            bool isStatic = false;
+            bool isMetaFunc = false;
 
-            if (tagMap.contains("construct"))
-                func->name = tagMap["construct"];
-            else if (tagMap.contains("func"))
-                func->name = tagMap["func"];
-            else if (tagMap.contains("static_func")) {
-                func->name = tagMap["static_func"];
-                func->isStatic = true;
-            } else if (tagMap.contains("meta_func")) {
-                func->name = tagMap["meta_func"];
-                func->isMetaFunc = true;
+            if (tagSet.has(DocTag::Construct))
+                name = tagSet[DocTag::Construct];
+            else if (tagSet.has(DocTag::Func))
+                name = tagSet[DocTag::Func];
+            else if (tagSet.has(DocTag::StaticFunc)) {
+                name = tagSet[DocTag::StaticFunc];
+                isStatic = true;
+            } else if (tagSet.has(DocTag::MetaFunc)) {
+                name = tagSet[DocTag::MetaFunc];
+                isMetaFunc = true;
             }
 
-            if (tagMap.contains("func_sig")) {
-                auto fullSig = parseFunctionSignature(tagMap["func_sig"], currentClass->name);
-                func->overloads = generateOverloads(fullSig);
-                if (func->name.empty() && !func->overloads.empty()) {
-                    func->name = func->overloads.front().name;
+            ArenaVector<OverloadInfo> overloads(resource);
+            if (tagSet.has(DocTag::FuncSig)) {
+                const auto sig = static_cast<ModelIndex>(typesInfo.signatures.size());
+                typesInfo.signatures.push_back(parseFunctionSignature(tagSet[DocTag::FuncSig], currentClass.name, typesInfo));
+                generateOverloads(sig, typesInfo, overloads);
+                if (name.empty()) {
+                    name = typesInfo.signatures[sig].name;
                 }
             }
 
-            if (tagMap.contains("construct")) {
-                currentClass->constructs.push_back(func);
+            if (tagSet.has(DocTag::Construct)) {
+                currentClass.constructs.push_back(addFunc(name, currentDoc, isStatic, isMetaFunc, std::move(overloads)));
             } else {
                 {
                     FuncInfo *existing = nullptr;
-                    for (auto &f: currentClass->funcs) {
-                        if (f->name == func->name && f->isMetaFunc == func->isMetaFunc && f->isStatic == func->isStatic) {
-                            existing = f.get();
+                    for (const ModelIndex f: currentClass.funcs) {
+                        FuncInfo &func = typesInfo.funcs[f];
+                        if (func.name == name && func.isMetaFunc == isMetaFunc && func.isStatic == isStatic) {
+                            existing = &func;
                             break;
                         }
                     }
 
                     if (existing) {
-                        existing->overloads.insert(
-                            existing->overloads.end(),
-                            func->overloads.begin(),
-                            func->overloads.end()
-                            );
+                        existing->overloads.insert(existing->overloads.end(), overloads.begin(), overloads.end());
                     } else {
-                        currentClass->funcs.push_back(func);
+                        currentClass.funcs.push_back(addFunc(name, currentDoc, isStatic, isMetaFunc, std::move(overloads)));
                     }
                 }
 
-                if (tagMap.contains("property_get") || tagMap.contains("property_set")) {
-                    std::string propName = tagMap.contains("property_get") ? tagMap["property_get"] : tagMap["property_set"];
+                if (tagSet.has(DocTag::PropertyGet) || tagSet.has(DocTag::PropertySet)) {
+                    std::string_view propName = tagSet.has(DocTag::PropertyGet) ? tagSet[DocTag::PropertyGet] : tagSet[DocTag::PropertySet];
                     auto it = propertyMap.find(propName);
-                    if (it == propertyMap.end()) {
-                        auto prop = std::make_shared<PropertyInfo>();
-                        prop->name = propName;
-                        currentClass->properties.push_back(prop);
-                        propertyMap[propName] = prop.get();
-                        it = propertyMap.find(propName);
-                    }
-                    if (it != propertyMap.end()) {
-                        auto lastFunc = currentClass->funcs.back();
-                        if (tagMap.contains("property_get")) {
-                            it->second->getter = lastFunc;
-                            it->second->hasGetter = true;
-                        } else {
-                            it->second->setter = lastFunc;
-                            it->second->hasSetter = true;
-                        }
+                    const ModelIndex propIndex = it != propertyMap.end() ? it->second : addProperty(currentClass, propName);
+                    PropertyInfo &prop = typesInfo.properties[propIndex];
+                    if (tagSet.has(DocTag::PropertyGet)) {
+                        prop.getter = currentClass.funcs.back();
+                    } else {
+                        prop.setter = currentClass.funcs.back();
                     }
                 }
             }
         }
     }
-
-    typesInfo.classInfos = {classes.begin(), classes.end()};
-    typesInfo.enumClassInfos = enumClasses;
-
-    resolveAllTypesFullQualified(typesInfo.classInfos);
-
-    return typesInfo;
 }
 
-std::string CppTypesInfoGen::removeFunctionSpecifiers(const std::string &str)
+std::string_view CppTypesInfoGen::removeFunctionSpecifiers(std::string_view str, ParseArena &arena)
 {
-    static const std::vector<std::string> specifiers = {
-        "inline",
-        "constexpr",
-        "virtual",
-        "explicit",
-        "friend",
-        "static",
-        "__stdcall",
-        "__cdecl",
-        "__thiscall",
-        "__fastcall",
-        "noexcept",
-        "mutable"
-    };
+    std::vector<std::string_view> tokens;
+    bool changed = false;
 
-    std::istringstream iss(str);
-    std::string token;
-    std::vector<std::string> tokens;
-
-    while (iss >> token) {
-        bool isSpecifier = false;
-        for (const auto &spec: specifiers) {
-            if (token == spec) {
-                isSpecifier = true;
-                break;
+    size_t pos = 0;
+    while (pos < str.size()) {
+        if (std::isspace(static_cast<unsigned char>(str[pos]))) {
+            // 只有单个空格分隔时输出才可能与输入一致
+            if (str[pos] != ' ' || pos == 0 || std::isspace(static_cast<unsigned char>(str[pos - 1]))) {
+                changed = true;
             }
+            ++pos;
+            continue;
         }
-        if (!isSpecifier) {
+        size_t end = pos;
+        while (end < str.size() && !std::isspace(static_cast<unsigned char>(str[end])))
+            ++end;
+        const std::string_view token = str.substr(pos, end - pos);
+        pos = end;
+
+        if (!FUNCTION_SPECIFIERS.contains(token)) {
             tokens.push_back(token);
+        } else {
+            changed = true;
         }
     }
 
-    std::ostringstream oss;
+    if (!changed && (str.empty() || str.back() != ' ')) {
+        return str;
+    }
+
+    std::string result;
     for (size_t i = 0; i < tokens.size(); ++i) {
         if (i > 0)
-            oss << " ";
-        oss << tokens[i];
+            result += ' ';
+        result += tokens[i];
     }
-    return oss.str();
+    return arena.intern(result);
 }
 
-std::pair<std::string, std::string> CppTypesInfoGen::extractFunctionNameAndReturnType(const std::string &sigHead, const std::string &className)
+std::pair<std::string_view, std::string_view> CppTypesInfoGen::extractFunctionNameAndReturnType(std::string_view sigHead, std::string_view className, ParseArena &arena)
 {
-    const std::string trimmed = trim(sigHead);
-    std::string name;
-    std::string retType;
-
-    static const std::regex opRegex(R"(operator\s*(\[\]|==|!=|<=|>=|<=>|<|>|&&|\|\||\+|-|\*|/|%|\^|&|\||~|!|=|\(\)|\[\]|\w+(::\w+)*))");
-    std::smatch match;
+    const std::string_view trimmed = trim(sigHead);
+    std::string_view name;
+    std::string_view retType;
+
+    // 取第一个后面跟着运算符的 "operator"
+    for (size_t opPos = trimmed.find("operator"); opPos != std::string_view::npos; opPos = trimmed.find("operator", opPos + 1)) {
+        size_t symPos = opPos + 8;
+        while (symPos < trimmed.size() && std::isspace(static_cast<unsigned char>(trimmed[symPos])))
+            ++symPos;
+        const size_t symLen = matchOperatorSymbol(trimmed.substr(symPos));
+        if (symLen == 0)
+            continue;
 
-    if (std::regex_search(trimmed, match, opRegex)) {
-        name = "operator" + match.str(1);
-        retType = removeFunctionSpecifiers(trim(trimmed.substr(0, match.position(0))));
+        if (symPos == opPos + 8) {
+            name = trimmed.substr(opPos, 8 + symLen);
+        } else {
+            name = arena.intern("operator" + std::string(trimmed.substr(symPos, symLen)));
+        }
+        retType = removeFunctionSpecifiers(trim(trimmed.substr(0, opPos)), arena);
         return {name, retType};
     }
 
@@ -796,121 +810,153 @@ std::pair<std::string, std::string> CppTypesInfoGen::extractFunctionNameAndRetur
         --start;
 
     name = trimmed.substr(start, end - start);
-    retType = removeFunctionSpecifiers(trim(trimmed.substr(0, start)));
+    retType = removeFunctionSpecifiers(trim(trimmed.substr(0, start)), arena);
 
     // 构造函数特殊处理：无返回类型
     if (name == className) {
-        retType = "";
+        retType = {};
     }
 
     return {name, retType};
 }
 
-void CppTypesInfoGen::resolveAllTypesFullQualified(std::vector<std::shared_ptr<ClassInfo> > &allClasses)
+struct ViewHash
 {
-    std::unordered_map<std::string, std::string> typeNameMap;
+    using is_transparent = void;
 
-    for (const auto &cls: allClasses) {
-        std::string classPath = cls->outerCppName.empty() ? cls->cppName : cls->outerCppName + "::" + cls->cppName;
+    size_t operator()(std::string_view str) const
+    {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+template<typename T>
+using ViewMap = std::unordered_map<std::string_view, T, ViewHash, std::equal_to<> >;
+
+void CppTypesInfoGen::resolveAllTypesFullQualified(TypesInfo &typesInfo)
+{
+    // 限定名拆分为作用域和基础名，建索引时拆分一次
+    struct QualifiedName
+    {
+        std::string_view scope;
+        std::string_view qualified;
+    };
 
-        typeNameMap[cls->cppName] = classPath;
-        typeNameMap[classPath] = classPath;
+    ParseArena &arena = *typesInfo.arena;
+    ViewMap<std::string_view> typeNameMap;
+    ViewMap<std::vector<QualifiedName> > candidates; // 基础名 -> 限定名，按首次出现的顺序
+    std::unordered_set<std::string_view, ViewHash, std::equal_to<> > indexed;
 
-        for (const auto &i: cls->aliases) {
-            typeNameMap[i.first] = i.second;
+    auto addType = [&](std::string_view key, std::string_view qualified) {
+        typeNameMap[key] = qualified;
+        if (!indexed.insert(qualified).second) {
+            return;
         }
+        const size_t pos = qualified.rfind("::");
+        if (pos == std::string_view::npos) {
+            candidates[qualified].push_back({{}, qualified});
+        } else {
+            candidates[qualified.substr(pos + 2)].push_back({qualified.substr(0, pos), qualified});
+        }
+    };
 
-        std::vector<std::string> outerChain;
-        if (!cls->outerCppName.empty()) {
-            std::istringstream iss(cls->outerCppName);
-            std::string part;
-            while (std::getline(iss, part, '.')) {
-                outerChain.push_back(part);
-            }
+    auto join = [&](std::string_view scope, std::string_view name) {
+        std::string joined(scope);
+        joined += "::";
+        joined += name;
+        return arena.intern(joined);
+    };
+
+    ViewMap<std::vector<const ClassInfo *> > children;
+    for (const auto &cls: typesInfo.classes) {
+        if (!cls.outerCppName.empty()) {
+            children[cls.outerCppName].push_back(&cls);
         }
+    }
 
-        for (const auto &e: cls->enums) {
-            std::string fullEnumPath = classPath + "::" + e->cppName;
-            typeNameMap[e->cppName] = fullEnumPath;
-            typeNameMap[cls->cppName + "::" + e->cppName] = fullEnumPath;
-            typeNameMap[fullEnumPath] = fullEnumPath;
+    for (const auto &cls: typesInfo.classes) {
+        const std::string_view classPath = cls.outerCppName.empty() ? cls.cppName : join(cls.outerCppName, cls.cppName);
 
-            if (!outerChain.empty()) {
-                std::string scoped = outerChain[0];
-                for (size_t i = 1; i < outerChain.size(); ++i)
-                    scoped += "::" + outerChain[i];
-                scoped += "::" + cls->cppName + "::" + e->cppName;
-                typeNameMap[scoped] = fullEnumPath;
-            }
+        addType(cls.cppName, classPath);
+        addType(classPath, classPath);
+
+        for (const auto &alias: cls.aliases) {
+            addType(alias.newName, alias.oldName);
+        }
+
+        for (const ModelIndex enumIndex: cls.enums) {
+            const EnumInfo &e = typesInfo.enums[enumIndex];
+            const std::string_view fullEnumPath = join(classPath, e.cppName);
+            addType(e.cppName, fullEnumPath);
+            addType(join(cls.cppName, e.cppName), fullEnumPath);
+            addType(fullEnumPath, fullEnumPath);
         }
 
-        for (const auto &other: allClasses) {
-            if (other->outerCppName == classPath) {
-                std::string fullSubClass = classPath + "::" + other->cppName;
-                typeNameMap[other->cppName] = fullSubClass;
-                typeNameMap[cls->cppName + "::" + other->cppName] = fullSubClass;
-                typeNameMap[fullSubClass] = fullSubClass;
+        if (const auto it = children.find(classPath); it != children.end()) {
+            for (const ClassInfo *other: it->second) {
+                const std::string_view fullSubClass = join(classPath, other->cppName);
+                addType(other->cppName, fullSubClass);
+                addType(join(cls.cppName, other->cppName), fullSubClass);
+                addType(fullSubClass, fullSubClass);
             }
         }
     }
 
-    auto splitQualified = [](const std::string &type) -> std::pair<std::string, std::string> {
-        const auto pos = type.rfind("::");
-        if (pos == std::string::npos)
-            return {"", type};
-        return {type.substr(0, pos), type.substr(pos + 2)};
-    };
-
-    auto fixType = [&](std::string &type) {
-        std::string trimmed = trim(type);
-        std::string prefix, core, suffix;
+    auto fixType = [&](std::string_view &type) {
+        std::string_view trimmed = trim(type);
+        std::string_view prefix;
 
         size_t start = 0;
-        if (trimmed.size() >= 6 && trimmed.compare(0, 6, "const ") == 0) {
+        if (trimmed.starts_with("const ")) {
             prefix = "const ";
             start = 6;
         }
 
         size_t end = trimmed.find_first_of("&*", start);
-        if (end == std::string::npos)
+        if (end == std::string_view::npos)
             end = trimmed.size();
 
-        core = trim(trimmed.substr(start, end - start));
-        suffix = trim(trimmed.substr(end));
+        const std::string_view core = trim(trimmed.substr(start, end - start));
+        const std::string_view suffix = trim(trimmed.substr(end));
 
-        if (typeNameMap.contains(core)) {
-            type = prefix + typeNameMap[core] + suffix;
-            return;
-        }
+        auto qualify = [&](std::string_view qualified) {
+            std::string fixed(prefix);
+            fixed += qualified;
+            fixed += suffix;
+            type = arena.intern(fixed);
+        };
 
-        auto [scope, base] = splitQualified(core);
-        for (const auto &[shortName, qualified]: typeNameMap) {
-            auto [fullScope, fullBase] = splitQualified(qualified);
-            if (base == fullBase) {
-                if (scope.empty() || scope == fullScope.substr(fullScope.rfind("::") + 1)) {
-                    type = prefix + qualified + suffix;
-                    break;
-                }
-            }
+        if (const auto it = typeNameMap.find(core); it != typeNameMap.end()) {
+            qualify(it->second);
+            return;
         }
-    };
 
-    auto fixSig = [&](FuncSigInfo &sig) {
-        for (auto &t: sig.argTypes) {
-            fixType(t);
-        }
-    };
+        // 按基础名查候选，作用域需与候选限定名的末尾部分一致
+        const size_t pos = core.rfind("::");
+        const std::string_view scope = pos == std::string_view::npos ? std::string_view{} : core.substr(0, pos);
+        const std::string_view base = pos == std::string_view::npos ? core : core.substr(pos + 2);
 
-    for (auto &cls: allClasses) {
-        for (auto &f: cls->funcs) {
-            for (auto &sig: f->overloads) {
-                fixSig(sig);
-            }
+        const auto it = candidates.find(base);
+        if (it == candidates.end()) {
+            return;
         }
-        for (auto &f: cls->constructs) {
-            for (auto &sig: f->overloads) {
-                fixSig(sig);
+        for (const auto &candidate: it->second) {
+            const std::string_view fullScope = candidate.scope;
+            if (scope.empty() || fullScope == scope ||
+                (fullScope.size() > scope.size() + 2 && fullScope.ends_with(scope) &&
+                 fullScope.substr(fullScope.size() - scope.size() - 2, 2) == "::")) {
+                qualify(candidate.qualified);
+                break;
             }
         }
+    };
+
+    // 所有签名都属于类的函数，参数和返回类型逐个修正一次即可；
+    // 返回类型会写进命名空间作用域的成员函数指针类型中，类内的简写名同样需要限定
+    for (auto &arg: typesInfo.args) {
+        fixType(arg.type);
+    }
+    for (auto &sig: typesInfo.signatures) {
+        fixType(sig.retType);
     }
 }
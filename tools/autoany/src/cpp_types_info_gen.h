@@ -5,134 +5,295 @@
 #ifndef CPP_TYPES_INFO_GEN_H
 #define CPP_TYPES_INFO_GEN_H
 
+#include "parse_arena.h"
+
+#include <array>
+#include <cstdint>
 #include <memory>
-#include <string>
-#include <vector>
 #include <set>
-#include <unordered_map>
+#include <span>
+#include <string>
+#include <string_view>
+
+
+/**
+ * 解析模型中的对象都保存在 TypesInfo 的数组里，互相之间用下标引用.
+ */
+using ModelIndex = uint32_t;
+
+static constexpr ModelIndex NO_INDEX = UINT32_MAX;
 
+/**
+ * TypesInfo 某个数组中一段连续的元素.
+ */
+struct ModelRange
+{
+    uint32_t begin = 0;
+    uint32_t count = 0;
+};
+
+struct ArgInfo
+{
+    std::string_view type;
+    std::string_view name;
+};
 
 struct FuncSigInfo
 {
-    std::string name;
-    std::vector<std::string> argTypes;
-    std::vector<std::string> argsNames;
-    std::vector<bool> hasDefaultArg;
-    std::string retType;
+    std::string_view name;
+    std::string_view retType;
+    ModelRange args;               // TypesInfo::args
+    uint32_t requiredArgCount = 0; // 之后的参数都有默认值
+    std::string_view cvQualifier;  // 成员函数的 const/volatile 限定，组成成员函数指针类型
+    std::string_view refQualifier; // & 或 &&
+    bool isStaticMember = false;   // 声明带 static，取地址得到的是普通函数指针
+};
+
+/**
+ * 重载引用一个声明的签名，只取前 argCount 个参数，默认参数展开出的重载不复制参数列表.
+ */
+struct OverloadInfo
+{
+    ModelIndex sig = NO_INDEX;
+    uint32_t argCount = 0;
 };
 
 struct FuncInfo
 {
-    std::string name;
-    std::vector<FuncSigInfo> overloads;
-    std::string doc;
+    explicit FuncInfo(std::pmr::memory_resource *resource)
+        : overloads(resource)
+    {
+    }
+
+    std::string_view name;
+    ArenaVector<OverloadInfo> overloads;
+    std::string_view doc;
     bool isMetaFunc = false;
     bool isStatic = false;
 };
 
 struct PropertyInfo
 {
-    std::string name;
-    std::shared_ptr<FuncInfo> getter;
-    std::shared_ptr<FuncInfo> setter;
-    bool hasGetter = false;
-    bool hasSetter = false;
+    std::string_view name;
+    ModelIndex getter = NO_INDEX; // TypesInfo::funcs
+    ModelIndex setter = NO_INDEX;
     bool packAgain = false;
-    std::string type;
-    std::string doc;
+    std::string_view type;
+    std::string_view doc;
 };
 
 struct EnumInfo
 {
-    std::string name;
-    std::string cppName;
-    std::string castTo;
-    std::vector<std::string> enumItems;
-    std::string doc;
+    std::string_view name;
+    std::string_view cppName;
+    std::string_view castTo;
+    ModelRange enumItems; // TypesInfo::enumItems
+    std::string_view doc;
 };
 
 struct EnumClassInfo
 {
-    std::string name;
-    std::string cppName;
-    std::string ns;
-    std::string castTo;
-    std::vector<std::string> enumItems;
-    std::string doc;
+    std::string_view name;
+    std::string_view cppName;
+    std::string_view ns;
+    std::string_view castTo;
+    ModelRange enumItems; // TypesInfo::enumItems
+    std::string_view doc;
     bool isDefEnum = false;
 };
 
 struct ConstantInfo
 {
-    std::string name;
+    std::string_view name;
+};
+
+struct AliasInfo
+{
+    std::string_view newName;
+    std::string_view oldName;
 };
 
 struct ClassInfo
 {
-    std::string name;
-    std::string cppName;
-    std::string ns;
-    std::string outerClass;
-    std::string outerCppName;
-    std::string doc;
-    std::vector<std::string> parents;
-    std::vector<std::shared_ptr<FuncInfo> > constructs;
-    std::vector<std::shared_ptr<FuncInfo> > funcs;
-    std::vector<std::shared_ptr<PropertyInfo> > properties;
-    std::vector<std::shared_ptr<EnumInfo> > enums;
-    std::vector<std::shared_ptr<ConstantInfo> > constants;
-    std::unordered_map<std::string, std::string> aliases;
+    explicit ClassInfo(std::pmr::memory_resource *resource)
+        : parents(resource), constructs(resource), funcs(resource), properties(resource),
+          enums(resource), constants(resource), aliases(resource)
+    {
+    }
+
+    std::string_view name;
+    std::string_view cppName;
+    std::string_view ns;
+    std::string_view outerClass;
+    std::string_view outerCppName;
+    std::string_view doc;
+    ArenaVector<std::string_view> parents;
+    ArenaVector<ModelIndex> constructs; // TypesInfo::funcs
+    ArenaVector<ModelIndex> funcs;      // TypesInfo::funcs
+    ArenaVector<ModelIndex> properties; // TypesInfo::properties
+    ArenaVector<ModelIndex> enums;      // TypesInfo::enums
+    ArenaVector<ConstantInfo> constants;
+    ArenaVector<AliasInfo> aliases;
 };
 
+/**
+ * 单个头文件的解析结果，所有容器和合成的字符串都分配在 arena 上，析构时整块释放.
+ * 其余文本字段引用传给 CppTypesInfoGen::parse 的源码缓冲区，源码缓冲区需要比 TypesInfo 活得久.
+ */
 struct TypesInfo
 {
-    std::string cppNamespace;
-    std::vector<std::shared_ptr<ClassInfo> > classInfos;
-    std::vector<std::shared_ptr<EnumClassInfo> > enumClassInfos;
-    std::vector<std::string> usingNameSpaces;
-    std::set<std::string> includeFromSet; // 提前声明从哪些头文件引入
-    std::string customRefCode;
+    explicit TypesInfo(size_t arenaSize = 4096)
+        : arena(std::make_unique<ParseArena>(arenaSize)),
+          classes(arena->resource()), funcs(arena->resource()), signatures(arena->resource()),
+          args(arena->resource()), properties(arena->resource()), enums(arena->resource()),
+          enumClasses(arena->resource()), enumItems(arena->resource()),
+          usingNameSpaces(arena->resource()), includeFromSet(arena->resource())
+    {
+    }
+
+    std::span<const ArgInfo> overloadArgs(const OverloadInfo &overload) const
+    {
+        return {args.data() + signatures[overload.sig].args.begin, overload.argCount};
+    }
+
+    std::span<const std::string_view> items(ModelRange range) const
+    {
+        return {enumItems.data() + range.begin, range.count};
+    }
+
+    std::unique_ptr<ParseArena> arena; // 必须最先构造、最后析构
+
+    std::string_view cppNamespace;
+    ArenaVector<ClassInfo> classes;
+    ArenaVector<FuncInfo> funcs;
+    ArenaVector<FuncSigInfo> signatures;
+    ArenaVector<ArgInfo> args;
+    ArenaVector<PropertyInfo> properties;
+    ArenaVector<EnumInfo> enums;
+    ArenaVector<EnumClassInfo> enumClasses;
+    ArenaVector<std::string_view> enumItems;
+    ArenaVector<std::string_view> usingNameSpaces;
+    std::pmr::set<std::string_view> includeFromSet; // 提前声明从哪些头文件引入
+    std::string_view customRefCode;
+    uint32_t commentBlockCount = 0; // 源码中的文档注释块数量
 };
 
 
 class CppTypesInfoGen
 {
+    friend class ParserBench;
+    friend class SignatureCheck;
+
 public:
-    static TypesInfo parse(const std::string &sourceCode);
+    static TypesInfo parse(std::string_view sourceCode);
 
 private:
+    struct CommentBlock
+    {
+        enum class Kind : uint8_t
+        {
+            Doc,
+            BeginScope,
+            EndScope,
+        };
+
+        Kind kind = Kind::Doc;
+        std::string_view text;      // 原始注释文本
+        std::string_view signature; // 规范化后的函数签名
+    };
+
+    enum class DocTag : uint8_t
+    {
+        Doc, // 普通文档行、@brief、@note
+        Ns,
+        CppNs,
+        IncludeFrom,
+        UsingNs,
+        BeginScope,
+        EndScope,
+        Class,
+        Struct,
+        Inherit,
+        Enum,
+        EnumItem,
+        CastTo,
+        CppName,
+        DefEnum,
+        RefCode,
+        Constant,
+        Alias,
+        Property,
+        PackAgain,
+        DefaultConstruct,
+        Construct,
+        Func,
+        StaticFunc,
+        MetaFunc,
+        PropertyGet,
+        PropertySet,
+        FuncSig,
+        Unknown,
+        Count
+    };
+
     struct TagItem
     {
-        std::string tag;
-        std::string value;
+        DocTag tag = DocTag::Unknown;
+        std::string_view value;
+    };
+
+    /**
+     * 一个注释块中每种标签最后一次出现的值，按 DocTag 直接寻址.
+     */
+    struct TagSet
+    {
+        bool has(DocTag tag) const
+        {
+            return mask & (uint64_t(1) << static_cast<size_t>(tag));
+        }
+
+        std::string_view operator[](DocTag tag) const
+        {
+            return values[static_cast<size_t>(tag)];
+        }
+
+        void set(DocTag tag, std::string_view value)
+        {
+            mask |= uint64_t(1) << static_cast<size_t>(tag);
+            values[static_cast<size_t>(tag)] = value;
+        }
+
+        uint64_t mask = 0;
+        std::array<std::string_view, static_cast<size_t>(DocTag::Count)> values{};
     };
 
     struct ParsedItem
     {
-        std::vector<TagItem> tags;
+        ModelRange tags; // 所有注释块的标签连续存放在同一个数组
+        std::string_view funcSig;
     };
 
-    static std::string stripDefaultValue(const std::string &param);
+    static DocTag findDocTag(std::string_view name);
 
-    static std::string normalizeFunctionSignature(const std::string &signature);
+    static std::string_view stripDefaultValue(std::string_view param);
 
-    static std::vector<FuncSigInfo> generateOverloads(const FuncSigInfo &sig);
+    static void generateOverloads(ModelIndex sig, const TypesInfo &typesInfo, ArenaVector<OverloadInfo> &overloads);
 
-    static std::vector<std::string> extractCommentBlocks(const std::string &source);
+    static ArenaVector<CommentBlock> extractCommentBlocks(std::string_view source, ParseArena &arena);
 
-    static std::vector<TagItem> parseDocComment(const std::string &commentText);
+    static void parseDocComment(std::string_view commentText, ArenaVector<TagItem> &tags);
 
-    static std::vector<ParsedItem> parseCommentBlocks(const std::vector<std::string> &commentBlocks);
+    static ArenaVector<ParsedItem> parseCommentBlocks(const ArenaVector<CommentBlock> &commentBlocks, ArenaVector<TagItem> &tags);
 
-    static FuncSigInfo parseFunctionSignature(const std::string &signature, const std::string &className);
+    static FuncSigInfo parseFunctionSignature(std::string_view signature, std::string_view className, TypesInfo &typesInfo);
 
-    static TypesInfo assembleTypesInfo(const std::vector<ParsedItem> &parsedItems);
+    static void assembleTypesInfo(const ArenaVector<ParsedItem> &parsedItems, const ArenaVector<TagItem> &tags, TypesInfo &typesInfo);
 
-    static std::string removeFunctionSpecifiers(const std::string &str);
+    static std::string_view removeFunctionSpecifiers(std::string_view str, ParseArena &arena);
 
-    static std::pair<std::string, std::string> extractFunctionNameAndReturnType(const std::string &sigHead, const std::string &className);
+    static std::pair<std::string_view, std::string_view> extractFunctionNameAndReturnType(std::string_view sigHead, std::string_view className, ParseArena &arena);
 
-    static void resolveAllTypesFullQualified(std::vector<std::shared_ptr<ClassInfo> > &allClasses);
+    static void resolveAllTypesFullQualified(TypesInfo &typesInfo);
 };
 
 #endif //CPP_TYPES_INFO_GEN_H
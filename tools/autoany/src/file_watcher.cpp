@@ -0,0 +1,170 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "file_watcher.h"
+
+#include <filesystem>
+#include <system_error>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+FileWatcher::~FileWatcher()
+{
+    stop();
+}
+
+#if defined(__linux__)
+
+static constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_DELETE_SELF;
+
+bool FileWatcher::start(const std::string &dirPath, Callback callback)
+{
+    stop();
+
+    mNotifyFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (mNotifyFd < 0) {
+        return false;
+    }
+    if (pipe(mStopPipe) != 0) {
+        ::close(mNotifyFd);
+        mNotifyFd = -1;
+        return false;
+    }
+
+    mCallback = std::move(callback);
+    mRootDir = dirPath;
+    addWatchRecursive(dirPath);
+    if (mWatchDirs.empty()) {
+        stop();
+        return false;
+    }
+
+    mThread = std::thread(&FileWatcher::watchLoop, this);
+    return true;
+}
+
+void FileWatcher::stop()
+{
+    if (mThread.joinable()) {
+        const char c = 0;
+        (void) !write(mStopPipe[1], &c, 1);
+        mThread.join();
+    }
+    if (mNotifyFd >= 0) {
+        ::close(mNotifyFd);
+        mNotifyFd = -1;
+    }
+    for (int &fd: mStopPipe) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    mWatchDirs.clear();
+}
+
+void FileWatcher::addWatchRecursive(const std::string &dirPath)
+{
+    const int wd = inotify_add_watch(mNotifyFd, dirPath.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        return;
+    }
+    mWatchDirs[wd] = dirPath;
+
+    std::error_code ec;
+    for (const auto &entry: std::filesystem::directory_iterator(dirPath, ec)) {
+        if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+            addWatchRecursive(entry.path().string());
+        }
+    }
+}
+
+void FileWatcher::watchLoop()
+{
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while (true) {
+        pollfd fds[2] = {
+            {mNotifyFd, POLLIN, 0},
+            {mStopPipe[0], POLLIN, 0},
+        };
+        if (poll(fds, 2, -1) < 0) {
+            continue;
+        }
+        if (fds[1].revents) {
+            return;
+        }
+
+        const ssize_t len = read(mNotifyFd, buffer, sizeof(buffer));
+        if (len <= 0) {
+            continue;
+        }
+
+        for (ssize_t pos = 0; pos < len;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(buffer + pos);
+            pos += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // 溢出期间新建的子目录可能没有监视，补充后通知调用方全部重新检查
+                addWatchRecursive(mRootDir);
+                mCallback({});
+                continue;
+            }
+
+            const auto it = mWatchDirs.find(event->wd);
+            if (it == mWatchDirs.end()) {
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                mWatchDirs.erase(it);
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+
+            const std::string path = it->second + "/" + event->name;
+            if (event->mask & IN_ISDIR) {
+                // 新建或移入的子目录需要补充监视，目录中已有的文件也视为变化
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    addWatchRecursive(path);
+                    std::error_code ec;
+                    for (const auto &entry: std::filesystem::recursive_directory_iterator(path, ec)) {
+                        if (entry.is_regular_file(ec)) {
+                            mCallback(entry.path().string());
+                        }
+                    }
+                }
+                continue;
+            }
+            mCallback(path);
+        }
+    }
+}
+
+#else
+
+bool FileWatcher::start(const std::string &dirPath, Callback callback)
+{
+    return false;
+}
+
+void FileWatcher::stop()
+{
+}
+
+void FileWatcher::addWatchRecursive(const std::string &dirPath)
+{
+}
+
+void FileWatcher::watchLoop()
+{
+}
+
+#endif
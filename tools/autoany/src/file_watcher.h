@@ -0,0 +1,50 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+
+/**
+ * 递归监视一个目录下的文件变化，在后台线程中回调发生变化的文件路径.
+ * 事件队列溢出、部分变化已经丢失时回调一次空路径，调用方需要重新检查全部文件.
+ * 目前只在 Linux 上通过 inotify 实现，其他平台 start() 返回 false，由调用方自行轮询.
+ */
+class FileWatcher
+{
+public:
+    using Callback = std::function<void(const std::string &path)>;
+
+    FileWatcher() = default;
+
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &) = delete;
+
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    bool start(const std::string &dirPath, Callback callback);
+
+    void stop();
+
+private:
+    void addWatchRecursive(const std::string &dirPath);
+
+    void watchLoop();
+
+private:
+    Callback mCallback;
+    std::thread mThread;
+    std::string mRootDir;
+    std::unordered_map<int, std::string> mWatchDirs; // watch descriptor -> 目录
+    int mNotifyFd = -1;
+    int mStopPipe[2] = {-1, -1};
+};
+
+#endif //FILE_WATCHER_H
@@ -0,0 +1,30 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "header_cache.h"
+
+
+void HeaderCache::share(const std::string &path)
+{
+    if (!mSlots.contains(path)) {
+        mSlots.emplace(path, std::make_unique<Slot>());
+    }
+}
+
+std::shared_ptr<const HeaderCache::Entry> HeaderCache::get(const std::string &path, uint64_t hash, std::string_view source)
+{
+    Slot &slot = *mSlots.at(path);
+    std::lock_guard lock(slot.mutex);
+    if (slot.entry && slot.hash == hash) {
+        ++mHits;
+        return slot.entry;
+    }
+
+    auto entry = std::make_shared<Entry>();
+    entry->source.assign(source);
+    entry->typesInfo.emplace(CppTypesInfoGen::parse(entry->source));
+    slot.hash = hash;
+    slot.entry = entry;
+    return entry;
+}
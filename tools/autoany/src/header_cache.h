@@ -0,0 +1,66 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef HEADER_CACHE_H
+#define HEADER_CACHE_H
+
+#include "cpp_types_info_gen.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+
+/**
+ * 批处理模式下被多个模块引用的头文件的解析结果，按绝对路径和内容哈希缓存，每个头文件只解析一次.
+ * 解析结果只依赖源码内容，与模块的基础路径、include 前缀无关，各模块的生成结果与单独运行一致.
+ */
+class HeaderCache
+{
+public:
+    struct Entry
+    {
+        std::string source; // typesInfo 中的文本引用这份源码
+        std::optional<TypesInfo> typesInfo;
+    };
+
+public:
+    /**
+     * 登记一个需要缓存的头文件，只能在开始生成前调用.
+     */
+    void share(const std::string &path);
+
+    bool isShared(const std::string &path) const
+    {
+        return mSlots.contains(path);
+    }
+
+    /**
+     * 返回 path 的解析结果，内容哈希不一致时用 source 重新解析.
+     */
+    std::shared_ptr<const Entry> get(const std::string &path, uint64_t hash, std::string_view source);
+
+    uint64_t hits() const
+    {
+        return mHits;
+    }
+
+private:
+    struct Slot
+    {
+        std::mutex mutex;
+        uint64_t hash = 0;
+        std::shared_ptr<const Entry> entry;
+    };
+
+    std::unordered_map<std::string, std::unique_ptr<Slot> > mSlots;
+    std::atomic<uint64_t> mHits = 0;
+};
+
+#endif //HEADER_CACHE_H
@@ -0,0 +1,225 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "input_scan.h"
+#include "mapped_file.h"
+#include "task_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+
+
+static constexpr int MAX_RESPONSE_DEPTH = 16;
+
+static bool expandArgs(const std::vector<std::string> &args, std::vector<std::string> &out, std::string &failedFile, int depth)
+{
+    for (const auto &arg: args) {
+        if (!arg.starts_with('@')) {
+            out.push_back(arg);
+            continue;
+        }
+        MappedFile file;
+        if (depth >= MAX_RESPONSE_DEPTH || !file.open(arg.substr(1))) {
+            failedFile = arg.substr(1);
+            return false;
+        }
+
+        // 空白分隔，引号内的空白保留；不处理反斜杠，Windows 路径可以原样写入
+        std::vector<std::string> fileArgs;
+        const std::string_view text = file.view();
+        std::string current;
+        bool inToken = false;
+        char quote = '\0';
+        for (const char c: text) {
+            if (quote) {
+                if (c == quote) {
+                    quote = '\0';
+                } else {
+                    current.push_back(c);
+                }
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+                inToken = true;
+            } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                if (inToken) {
+                    fileArgs.push_back(std::move(current));
+                    current.clear();
+                    inToken = false;
+                }
+            } else {
+                current.push_back(c);
+                inToken = true;
+            }
+        }
+        if (inToken) {
+            fileArgs.push_back(std::move(current));
+        }
+
+        if (!expandArgs(fileArgs, out, failedFile, depth + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool InputScan::expandResponseFiles(const std::vector<std::string> &args, std::vector<std::string> &out, std::string &failedFile)
+{
+    return expandArgs(args, out, failedFile, 0);
+}
+
+static bool matchFrom(std::string_view pattern, std::string_view path)
+{
+    while (!pattern.empty()) {
+        if (pattern.starts_with("**")) {
+            pattern.remove_prefix(2);
+            // "a/**/b" 也匹配 "a/b"
+            if (pattern.starts_with('/') && matchFrom(pattern.substr(1), path)) {
+                return true;
+            }
+            for (size_t i = 0; i <= path.size(); ++i) {
+                if (matchFrom(pattern, path.substr(i))) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        if (pattern[0] == '*') {
+            pattern.remove_prefix(1);
+            for (size_t i = 0;; ++i) {
+                if (matchFrom(pattern, path.substr(i))) {
+                    return true;
+                }
+                if (i == path.size() || path[i] == '/') {
+                    return false;
+                }
+            }
+        }
+        if (path.empty()) {
+            return false;
+        }
+        if (pattern[0] == '?' ? path[0] == '/' : pattern[0] != path[0]) {
+            return false;
+        }
+        pattern.remove_prefix(1);
+        path.remove_prefix(1);
+    }
+    return path.empty();
+}
+
+bool InputScan::matchGlob(std::string_view pattern, std::string_view path)
+{
+    if (pattern.find('/') == std::string_view::npos) {
+        const size_t slash = path.rfind('/');
+        if (slash != std::string_view::npos) {
+            path.remove_prefix(slash + 1);
+        }
+    }
+    return matchFrom(pattern, path);
+}
+
+bool InputScan::hasReflectTags(std::string_view source)
+{
+    static constexpr std::string_view TAGS[] = {"class", "struct", "enum", "ref_code"};
+
+    // memchr 由 libc 向量化实现，大多数头文件中 '@' 很少，只在命中处比较标签名
+    const char *p = source.data();
+    const char *end = p + source.size();
+    while (p < end) {
+        const auto *at = static_cast<const char *>(memchr(p, '@', end - p));
+        if (!at) {
+            break;
+        }
+        p = at + 1;
+        const auto rest = static_cast<size_t>(end - p);
+        for (const auto &tag: TAGS) {
+            if (rest >= tag.size() && memcmp(p, tag.data(), tag.size()) == 0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static bool matchAny(const std::vector<std::string> &globs, std::string_view path)
+{
+    return std::any_of(globs.begin(), globs.end(), [&](const std::string &glob) {
+        return InputScan::matchGlob(glob, path);
+    });
+}
+
+static bool isExcludedDir(const std::vector<std::string> &excludeGlobs, std::string_view dir)
+{
+    return std::any_of(excludeGlobs.begin(), excludeGlobs.end(), [&](std::string_view glob) {
+        if (InputScan::matchGlob(glob, dir)) {
+            return true;
+        }
+        // "third_party/**" 直接跳过整个目录
+        return glob.ends_with("/**") && InputScan::matchGlob(glob.substr(0, glob.size() - 3), dir);
+    });
+}
+
+InputScan::Result InputScan::scan(TaskPool &taskPool, const std::string &dir,
+                                  const std::vector<std::string> &includeGlobs, const std::vector<std::string> &excludeGlobs)
+{
+    namespace fs = std::filesystem;
+
+    Result result;
+    std::error_code ec;
+    const fs::path root = fs::absolute(dir, ec).lexically_normal();
+    if (ec) {
+        return result;
+    }
+
+    // 按层并行：同一层的目录分给各个工作线程，避免一个大子目录拖住整个遍历
+    std::vector<std::string> candidates;
+    std::vector<std::string> frontier{""};
+    std::atomic<size_t> visited = 0;
+    while (!frontier.empty()) {
+        std::vector<std::vector<std::string> > subdirs(frontier.size());
+        std::vector<std::vector<std::string> > files(frontier.size());
+        taskPool.run(frontier.size(), [&](size_t index) {
+            const std::string &parent = frontier[index];
+            std::error_code iterEc;
+            fs::directory_iterator it(parent.empty() ? root : root / parent, fs::directory_options::skip_permission_denied, iterEc);
+            for (; !iterEc && it != fs::directory_iterator(); it.increment(iterEc)) {
+                const std::string name = it->path().filename().generic_string();
+                const std::string relPath = parent.empty() ? name : parent + "/" + name;
+                std::error_code typeEc;
+                if (it->is_directory(typeEc) && !it->is_symlink(typeEc)) {
+                    if (!isExcludedDir(excludeGlobs, relPath)) {
+                        subdirs[index].push_back(relPath);
+                    }
+                } else if (it->is_regular_file(typeEc)) {
+                    ++visited;
+                    if (matchAny(includeGlobs, relPath) && !matchAny(excludeGlobs, relPath)) {
+                        files[index].push_back(relPath);
+                    }
+                }
+            }
+        });
+
+        frontier.clear();
+        for (size_t i = 0; i < subdirs.size(); ++i) {
+            frontier.insert(frontier.end(), subdirs[i].begin(), subdirs[i].end());
+            candidates.insert(candidates.end(), files[i].begin(), files[i].end());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    result.visited = visited;
+    result.matched = candidates.size();
+
+    std::vector<char> keep(candidates.size(), 0);
+    taskPool.run(candidates.size(), [&](size_t index) {
+        MappedFile file;
+        keep[index] = file.open((root / candidates[index]).string()) && hasReflectTags(file.view());
+    });
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (keep[i]) {
+            result.files.push_back((root / candidates[i]).string());
+        }
+    }
+    return result;
+}
@@ -0,0 +1,56 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef INPUT_SCAN_H
+#define INPUT_SCAN_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+class TaskPool;
+
+
+/**
+ * 大量头文件的输入发现：展开 @response 文件，或并行遍历目录、按 glob 过滤，
+ * 并跳过不含反射标签的头文件，避免把整棵源码树交给解析.
+ */
+class InputScan
+{
+public:
+    struct Result
+    {
+        std::vector<std::string> files; // 含反射标签的头文件绝对路径，按路径排序
+        size_t visited = 0;             // 遍历到的文件数
+        size_t matched = 0;             // 通过 glob 过滤的文件数
+    };
+
+public:
+    /**
+     * 把以 '@' 开头的参数替换为对应文件中以空白分隔的参数，引号内的空白保留，可以嵌套.
+     * 文件无法读取或嵌套过深时返回 false，failedFile 为出错的响应文件.
+     */
+    static bool expandResponseFiles(const std::vector<std::string> &args, std::vector<std::string> &out, std::string &failedFile);
+
+    /**
+     * '*' 匹配除 '/' 外的任意字符，'**' 可跨越目录，'?' 匹配一个除 '/' 外的字符.
+     * 不含 '/' 的模式只与文件名比较，否则与相对扫描目录的路径比较.
+     */
+    static bool matchGlob(std::string_view pattern, std::string_view path);
+
+    /**
+     * 源码中是否有 @class、@struct、@enum 或 @ref_code 标签，没有时头文件不会生成任何反射代码.
+     * 只做快速预筛，不判断标签是否位于注释中.
+     */
+    static bool hasReflectTags(std::string_view source);
+
+    /**
+     * 并行遍历 dir，返回通过 include/exclude 过滤且含反射标签的文件.
+     * exclude 匹配的目录不会进入，符号链接的目录不跟随.
+     */
+    static Result scan(TaskPool &taskPool, const std::string &dir,
+                       const std::vector<std::string> &includeGlobs, const std::vector<std::string> &excludeGlobs);
+};
+
+#endif //INPUT_SCAN_H
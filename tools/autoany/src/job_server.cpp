@@ -0,0 +1,161 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "job_server.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+
+std::unique_ptr<JobServer> JobServer::fromEnvironment()
+{
+    const char *makeflags = std::getenv("MAKEFLAGS");
+    if (!makeflags) {
+        return nullptr;
+    }
+    const std::string auth = parseAuth(makeflags);
+    if (auth.empty()) {
+        return nullptr;
+    }
+    std::unique_ptr<JobServer> jobServer(new JobServer());
+    if (!jobServer->open(auth)) {
+        return nullptr;
+    }
+    return jobServer;
+}
+
+std::string JobServer::parseAuth(std::string_view makeflags)
+{
+    // 递归的 make 会追加参数，以最后一次出现的为准
+    std::string auth;
+    size_t pos = 0;
+    while (pos < makeflags.size()) {
+        const size_t end = std::min(makeflags.find(' ', pos), makeflags.size());
+        const std::string_view word = makeflags.substr(pos, end - pos);
+        for (const std::string_view prefix: {"--jobserver-auth=", "--jobserver-fds="}) {
+            if (word.starts_with(prefix)) {
+                auth = word.substr(prefix.size());
+            }
+        }
+        pos = end + 1;
+    }
+    return auth;
+}
+
+#if defined(_WIN32)
+
+JobServer::~JobServer()
+{
+    if (mSemaphore) {
+        CloseHandle(mSemaphore);
+    }
+}
+
+bool JobServer::open(const std::string &auth)
+{
+    mSemaphore = OpenSemaphoreA(SEMAPHORE_MODIFY_STATE | SYNCHRONIZE, FALSE, auth.c_str());
+    return mSemaphore != nullptr;
+}
+
+bool JobServer::acquire(int timeoutMs)
+{
+    return WaitForSingleObject(mSemaphore, static_cast<DWORD>(timeoutMs)) == WAIT_OBJECT_0;
+}
+
+void JobServer::release()
+{
+    ReleaseSemaphore(mSemaphore, 1, nullptr);
+}
+
+#else
+
+JobServer::~JobServer()
+{
+    if (mOwnReadFd) {
+        ::close(mReadFd);
+    }
+    if (mOwnWriteFd && mWriteFd != mReadFd) {
+        ::close(mWriteFd);
+    }
+}
+
+bool JobServer::open(const std::string &auth)
+{
+    if (auth.starts_with("fifo:")) {
+        const int fd = ::open(auth.c_str() + 5, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        mReadFd = mWriteFd = fd;
+        mOwnReadFd = mOwnWriteFd = true;
+        return true;
+    }
+
+    const size_t comma = auth.find(',');
+    if (comma == std::string::npos) {
+        return false;
+    }
+    const int readFd = std::atoi(auth.c_str());
+    const int writeFd = std::atoi(auth.c_str() + comma + 1);
+    // make 只把描述符传给它认为是递归调用的命令，其余情况下描述符已关闭
+    if (readFd < 0 || writeFd < 0 || fcntl(readFd, F_GETFD) == -1 || fcntl(writeFd, F_GETFD) == -1) {
+        return false;
+    }
+
+    // 管道的文件状态是共享的，不能直接改成非阻塞；Linux 上重新打开得到独立的非阻塞读端
+    const std::string procPath = "/proc/self/fd/" + std::to_string(readFd);
+    const int ownFd = ::open(procPath.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (ownFd >= 0) {
+        mReadFd = ownFd;
+        mOwnReadFd = true;
+    } else {
+        mReadFd = readFd;
+    }
+    mWriteFd = writeFd;
+    return true;
+}
+
+bool JobServer::acquire(int timeoutMs)
+{
+    pollfd pfd{mReadFd, POLLIN, 0};
+    if (poll(&pfd, 1, timeoutMs) <= 0 || !(pfd.revents & POLLIN)) {
+        return false;
+    }
+    // 其他进程可能先取走了令牌，非阻塞读端此时返回 EAGAIN
+    char token;
+    if (::read(mReadFd, &token, 1) != 1) {
+        return false;
+    }
+    std::lock_guard lock(mMutex);
+    mTokens.push_back(token);
+    return true;
+}
+
+void JobServer::release()
+{
+    char token = '+';
+    {
+        std::lock_guard lock(mMutex);
+        if (!mTokens.empty()) {
+            token = mTokens.back();
+            mTokens.pop_back();
+        }
+    }
+    while (::write(mWriteFd, &token, 1) < 0 && errno == EINTR) {
+    }
+}
+
+#endif
@@ -0,0 +1,65 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef JOB_SERVER_H
+#define JOB_SERVER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * GNU make jobserver 客户端.
+ * 在并行 make 中运行时从 MAKEFLAGS 的 --jobserver-auth（或旧版的 --jobserver-fds）找到令牌来源：
+ * fifo:PATH、管道读写描述符 R,W，Windows 上为信号量名.
+ * 进程本身持有一个隐含令牌，每个额外的工作线程干活前取一个令牌，结束后归还.
+ */
+class JobServer
+{
+public:
+    /**
+     * 不在 jobserver 下运行或描述符不可用时返回空.
+     */
+    static std::unique_ptr<JobServer> fromEnvironment();
+
+    /**
+     * 解析 MAKEFLAGS，返回 --jobserver-auth 的值，没有时返回空串.
+     */
+    static std::string parseAuth(std::string_view makeflags);
+
+    ~JobServer();
+
+    JobServer(const JobServer &) = delete;
+
+    JobServer &operator=(const JobServer &) = delete;
+
+    /**
+     * 最多等待 timeoutMs 毫秒取一个令牌.
+     */
+    bool acquire(int timeoutMs);
+
+    void release();
+
+private:
+    JobServer() = default;
+
+    bool open(const std::string &auth);
+
+private:
+#if defined(_WIN32)
+    void *mSemaphore = nullptr;
+#else
+    int mReadFd = -1;
+    int mWriteFd = -1;
+    bool mOwnReadFd = false;
+    bool mOwnWriteFd = false;
+    std::mutex mMutex;
+    std::vector<char> mTokens; // 取到的令牌字节，归还时原样写回
+#endif
+};
+
+#endif //JOB_SERVER_H
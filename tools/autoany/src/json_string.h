@@ -0,0 +1,54 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef JSON_STRING_H
+#define JSON_STRING_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+
+/**
+ * 转义为带引号的 JSON 字符串，控制字符使用 \u 形式，输出始终是单行.
+ */
+inline std::string jsonString(std::string_view value)
+{
+    std::string out;
+    out.reserve(value.size() + 2);
+    out += '"';
+    for (const char ch: value) {
+        switch (ch) {
+            case '\\':
+                out += "\\\\";
+                break;
+            case '"':
+                out += "\\\"";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<uint8_t>(ch) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", ch);
+                    out += buf;
+                } else {
+                    out.push_back(ch);
+                }
+                break;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+#endif //JSON_STRING_H
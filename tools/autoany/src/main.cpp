@@ -3,6 +3,18 @@
 //
 
 #include "to_any_gen.h"
+#include "task_pool.h"
+#include "build_manifest.h"
+#include "output_file.h"
+#include "mapped_file.h"
+#include "run_stats.h"
+#include "file_watcher.h"
+#include "source_lexer.h"
+#include "shard_plan.h"
+#include "types_manifest.h"
+#include "job_server.h"
+#include "header_cache.h"
+#include "input_scan.h"
 
 #define USE_GANY_CORE
 #include <gx/gany.h>
@@ -12,25 +24,82 @@
 
 #include <getopt/getopt.h>
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
 
 static std::string sOutput;
 static std::string sBasePath;
 static std::string sIncludePrefix;
 static std::string sModuleName;
+static std::string sDepfile;
+static size_t sJobs = 1;
+static bool sJobsSet = false;
+static std::unique_ptr<JobServer> sJobServer;
+static std::string sBatchFile;
+static std::string sScanDir;
+static std::vector<std::string> sIncludeGlobs;
+static std::vector<std::string> sExcludeGlobs;
+static HeaderCache *sHeaderCache = nullptr; // 只在批处理模式下使用
+static bool sForce = false;
+static bool sStats = false;
+static bool sServe = false;
+static bool sEmitTypes = false;
+static bool sDeterministic = false;
+static bool sSelfCheck = false;
+static uint32_t sShards = 0;
+static ToAnyGen::Options sGenOptions;
+static RunStats::Format sStatsFormat = RunStats::Format::Text;
+
+// 写入清单，版本不同时全部重新生成；生成代码的格式有变化时需要提高版本号
+static constexpr const char *AUTOANY_VERSION = "1.2.12";
+
+// 上一次运行的清单，解析期间只读
+static BuildManifest sPrevManifest;
+static bool sIncremental = false;
+static TypesManifest sPrevTypes;
 
 
 struct FileReflecInfo
 {
     std::string refFileName;
     std::string refFuncName;
+    std::string srcShortPath;
+    uint64_t srcHash = 0;
+    uint64_t weight = 0;
+    uint32_t shard = ShardPlan::NO_SHARD;
+    std::vector<std::string> refIncludes; // 分片模式下暂存的 include 行和反射函数代码
+    std::string refCode;
+    std::string typesRecord; // --emit-manifest 时该头文件在类型清单中的记录
+    std::vector<std::string> includes; // @include_from 引入的头文件
+    FileStats stats;
 };
 
 
 static const char *USAGE = R"TXT(Usage:
 APP_NAME [options] -m "Gx" -b "include/gx" -p "gx/" -o "./gx/toany/" gx/include/a.h gx/include/b.h
+APP_NAME [options] -m "Gx" -b "include/gx" -p "gx/" -o "./gx/toany/" @headers.txt
+APP_NAME [options] -m "Gx" -b "include/gx" -p "gx/" -o "./gx/toany/" --scan=include/gx --exclude-glob="detail/**"
 
 Automatically parse source code files and generate reflection code for classes, structures, and enumerations.
 
+An input starting with '@' is a response file: its whitespace separated contents (quotes keep spaces) are read
+as further inputs, so header lists are not limited by the command line length.
+
 Options:
     --help, -h
         Print this message.
@@ -42,6 +111,72 @@ Options:
         When generating code, include the prefix of the source file.
     --output=string, -o string
         Output path.
+    --jobs=N, -j N
+        Number of files parsed and generated in parallel, 0 means the number of hardware threads (default 1).
+        Under a GNU make jobserver (MAKEFLAGS --jobserver-auth, fifo or pipe) the default is the number of
+        hardware threads and every thread beyond the first takes a job token, so the total stays within make -j.
+    --force, -f
+        Ignore the manifest in the output path and regenerate all files.
+    --stats[=text|json], -s[json]
+        Report per-file sizes, counts and parse/generate/write times, plus wall time and peak RSS.
+        text is printed to stdout, json is written to autoany.stats.json in the output path.
+    --shards=N, -n N
+        Emit the reflection functions into N translation units ref_<Module>_shard<K>.cpp instead of one ref file
+        per header, balanced by estimated template instantiation weight. Headers keep their shard across runs,
+        so editing one header only rebuilds its own shard. reg_<Module>.cpp is unchanged.
+    --arity-dispatch, -a
+        Bind each function whose overloads all come from one signature with default arguments as a single variadic
+        function that dispatches on the argument count, instead of one binding per argument count.
+    --lazy, -l
+        Register lazily: loading the module only records "namespace.Class" -> registration function entries in
+        autoany::LazyClassTable (autoany_lazy.h), and a class's full builder chain runs the first time it is required.
+        reg_<Module>.cpp adds <Module>_RequireClass("ns.Class") and <Module>_RequireAllClasses(), declared in
+        reg_<Module>_lazy.h; setting the environment variable AUTOANY_EAGER_REGISTRATION=1 registers everything at
+        module load. GAny's own class lookup does not trigger registration: scripts that import or look up a class
+        find nothing until the host calls one of these functions.
+    --tables, -t
+        Emit each class's functions and getter/setter properties as static descriptor tables (name, doc, argument
+        names, call thunk) registered by one shared loop in autoany_table.h, instead of one builder call per member.
+        Overloads with the same argument count, meta functions and fields stay in the builder chain.
+    --profile, -P
+        Time the registration of every header (around each ref_<header>() call in reg_<Module>.cpp) and of every
+        class. Samples are returned by <Module>_RegistrationProfile() and by the C function
+        autoany_registration_profile_<Module>, which doc_make --profile reads to print a sorted report.
+    --emit-manifest, -e
+        Also write <Module>.types.json to the output path: the parsed types info of every header (classes, functions
+        with their overload signatures, properties, enums, docs and namespaces) as versioned JSON, so other tools can
+        read the module's API without parsing the headers or loading the module.
+    --depfile=path, -d path
+        Write a Makefile-style depfile listing, for every ref file or shard, the headers it depends on: its source
+        headers and the @include_from headers found relative to the output path, the base path or the source
+        header. Unchanged outputs keep their mtimes, so ninja's restat skips recompiling them.
+    --deterministic, -D
+        Make the output byte-reproducible: inputs are sorted by path and deduplicated, path separators in generated
+        includes are normalized to '/', shards are assigned from the weights alone instead of staying where the
+        previous run put them, and the manifest does not depend on the absolute base path.
+    --self-check, -c
+        After generating, generate everything again into a temporary directory without the incremental state
+        and fail if any file's digest differs. Implies --deterministic.
+    --batch=file, -B file
+        Generate several modules in one process. The file lists the modules, each starting with a "module <name>"
+        line followed by "base-path", "include-prefix", "output", "depfile" and one "input" line per header.
+        The other command line options apply to every module. Modules share one worker pool, headers listed by
+        more than one module are parsed once, and each module's output is identical to a separate run.
+    --scan=dir, -r dir
+        Walk dir (under the base path) in parallel and add every file matching the include globs and none of the
+        exclude globs, skipping files with no @class, @struct, @enum or @ref_code tag without parsing them.
+        Can be combined with inputs given on the command line.
+    --include-glob=pattern, -I pattern
+        File pattern for --scan, repeatable (default *.h and *.hpp). '*' and '?' stay within a directory, '**'
+        spans directories. A pattern without '/' matches the file name, otherwise the path relative to dir.
+    --exclude-glob=pattern, -X pattern
+        File or directory pattern skipped by --scan, repeatable. Excluded directories are not entered.
+    --serve, -S
+        After generating, keep running: watch the base path and regenerate the files affected by each change.
+        Commands are read from stdin one per line, replies are written to stdout prefixed with '@':
+            status    @current, @pending N or @failed N
+            wait      block until all outputs are up to date, then @current or @failed N
+            quit      @bye, then exit (closing stdin also exits)
 
 Doc Tags:
     @using_ns [namespace]       Indicates the need to using a namespace.
@@ -83,13 +218,30 @@ static void printUsage(const char *name)
 
 static int handleArguments(int argc, char *argv[])
 {
-    constexpr static const char *OPTSTR = "hm:b:p:o:";
+    constexpr static const char *OPTSTR = "hm:b:p:o:j:fs::n:altPed:DcB:r:I:X:S";
     static const option OPTIONS[] = {
         {"help", no_argument, nullptr, 'h'},
         {"module-name", required_argument, nullptr, 'm'},
         {"base-path", required_argument, nullptr, 'b'},
         {"include-prefix", required_argument, nullptr, 'p'},
         {"output", required_argument, nullptr, 'o'},
+        {"jobs", required_argument, nullptr, 'j'},
+        {"force", no_argument, nullptr, 'f'},
+        {"stats", optional_argument, nullptr, 's'},
+        {"shards", required_argument, nullptr, 'n'},
+        {"arity-dispatch", no_argument, nullptr, 'a'},
+        {"lazy", no_argument, nullptr, 'l'},
+        {"tables", no_argument, nullptr, 't'},
+        {"profile", no_argument, nullptr, 'P'},
+        {"emit-manifest", no_argument, nullptr, 'e'},
+        {"depfile", required_argument, nullptr, 'd'},
+        {"deterministic", no_argument, nullptr, 'D'},
+        {"self-check", no_argument, nullptr, 'c'},
+        {"batch", required_argument, nullptr, 'B'},
+        {"scan", required_argument, nullptr, 'r'},
+        {"include-glob", required_argument, nullptr, 'I'},
+        {"exclude-glob", required_argument, nullptr, 'X'},
+        {"serve", no_argument, nullptr, 'S'},
         {nullptr, 0, nullptr, 0}
     };
 
@@ -120,135 +272,1247 @@ static int handleArguments(int argc, char *argv[])
                 sOutput = arg;
             }
             break;
+            case 'j': {
+                sJobsSet = true;
+                const long jobs = strtol(arg.c_str(), nullptr, 10);
+                if (jobs > 0) {
+                    sJobs = static_cast<size_t>(jobs);
+                } else {
+                    sJobs = std::max(1u, std::thread::hardware_concurrency());
+                }
+            }
+            break;
+            case 'f': {
+                sForce = true;
+            }
+            break;
+            case 'n': {
+                const long shards = strtol(arg.c_str(), nullptr, 10);
+                sShards = shards > 0 ? static_cast<uint32_t>(shards) : 0;
+            }
+            break;
+            case 'a': {
+                sGenOptions.arityDispatch = true;
+            }
+            break;
+            case 'l': {
+                sGenOptions.lazyRegistration = true;
+            }
+            break;
+            case 't': {
+                sGenOptions.registrationTables = true;
+            }
+            break;
+            case 'P': {
+                sGenOptions.registrationProfile = true;
+            }
+            break;
+            case 'e': {
+                sEmitTypes = true;
+            }
+            break;
+            case 'd': {
+                sDepfile = arg;
+            }
+            break;
+            case 'D': {
+                sDeterministic = true;
+            }
+            break;
+            case 'c': {
+                // 不沿用上一次的分片分配，两次生成的输出才可比较
+                sSelfCheck = true;
+                sDeterministic = true;
+            }
+            break;
+            case 'B': {
+                sBatchFile = arg;
+            }
+            break;
+            case 'r': {
+                sScanDir = arg;
+            }
+            break;
+            case 'I': {
+                sIncludeGlobs.push_back(arg);
+            }
+            break;
+            case 'X': {
+                sExcludeGlobs.push_back(arg);
+            }
+            break;
+            case 'S': {
+                sServe = true;
+            }
+            break;
+            case 's': {
+                sStats = true;
+                if (arg == "json") {
+                    sStatsFormat = RunStats::Format::Json;
+                } else if (arg.empty() || arg == "text") {
+                    sStatsFormat = RunStats::Format::Text;
+                } else {
+                    printUsage(argv[0]);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            break;
         }
     }
 
     return optind;
 }
 
-int32_t parseFile(GFile &file, FileReflecInfo &info)
+static std::vector<std::string> genRefIncludes(const TypesInfo &typesInfo, const FileReflecInfo &info)
 {
-    if (!file.open(GFile::ReadOnly)) {
-        return -1;
+    std::vector<std::string> includes;
+    includes.push_back("#include <" + sIncludePrefix + info.srcShortPath + ">");
+    for (const auto &i : typesInfo.includeFromSet) {
+        includes.push_back("#include \"" + std::string(i) + "\"");
+    }
+    if (ToAnyGen::needsEnumHeader(typesInfo)) {
+        includes.push_back("#include \"" + std::string(ToAnyGen::ENUM_HEADER_FILE_NAME) + "\"");
     }
+    if (sGenOptions.lazyRegistration && (!typesInfo.classes.empty() || !typesInfo.enumClasses.empty())) {
+        includes.push_back("#include \"" + std::string(ToAnyGen::LAZY_HEADER_FILE_NAME) + "\"");
+    }
+    if (sGenOptions.registrationTables && !typesInfo.classes.empty()) {
+        includes.push_back("#include \"" + std::string(ToAnyGen::TABLE_HEADER_FILE_NAME) + "\"");
+    }
+    if (sGenOptions.registrationProfile && (!typesInfo.classes.empty() || !typesInfo.enumClasses.empty())) {
+        includes.push_back("#include \"" + std::string(ToAnyGen::PROFILE_HEADER_FILE_NAME) + "\"");
+    }
+    return includes;
+}
 
-    std::string source = file.readAll().toStdString();
-    file.close();
+static void genRefUsingCode(std::stringstream &refCode, const TypesInfo &typesInfo, std::string_view indent)
+{
+    if (!typesInfo.cppNamespace.empty()) {
+        auto nss = GString(std::string(typesInfo.cppNamespace)).split("::");
+        for (const auto &i : nss) {
+            refCode << indent << "using namespace " << i << ";\n";
+        }
+    }
+
+    for (const auto &uns: typesInfo.usingNameSpaces) {
+        if (typesInfo.cppNamespace != uns) {
+            refCode << indent << "using namespace " << uns << ";\n";
+        }
+    }
 
-    const TypesInfo typesInfo = CppTypesInfoGen::parse(source);
+    refCode << indent << "using namespace gany;\n";
+}
 
+static void appendIndented(std::stringstream &refCode, const std::string &code)
+{
+    std::string line;
+    std::istringstream input(code);
+    while (std::getline(input, line)) {
+        if (line.empty()) {
+            refCode << "\n";
+            continue;
+        }
+        refCode << "    " << line << "\n";
+    }
+}
+
+static void genRefFuncBody(std::stringstream &refCode, const TypesInfo &typesInfo, const FileReflecInfo &info)
+{
+    const bool lazy = sGenOptions.lazyRegistration;
+    const bool profile = sGenOptions.registrationProfile;
+    if (lazy && (!typesInfo.classes.empty() || !typesInfo.enumClasses.empty())) {
+        refCode << "\n    auto &lazyTable = autoany::LazyClassTable::instance();\n";
+    }
+
+    // 计时放在延迟注册函数内部，统计的是构建链真正执行的耗时
+    for (const auto &enumInfo: typesInfo.enumClasses) {
+        std::string code = ToAnyGen::genReflecEnumClassCode(typesInfo, enumInfo);
+        if (profile) {
+            code = ToAnyGen::genProfiledCode(code, sModuleName, info.srcShortPath, ToAnyGen::qualifiedName(enumInfo));
+        }
+        if (lazy) {
+            code = ToAnyGen::genLazyEnumClassCode(enumInfo, code);
+        }
+        refCode << "\n";
+        appendIndented(refCode, code);
+    }
+
+    for (const auto &classInfo: typesInfo.classes) {
+        std::string code = ToAnyGen::genReflecClassCode(typesInfo, classInfo, sGenOptions);
+        if (profile) {
+            code = ToAnyGen::genProfiledCode(code, sModuleName, info.srcShortPath, ToAnyGen::qualifiedName(classInfo));
+        }
+        if (lazy) {
+            code = ToAnyGen::genLazyClassCode(typesInfo, classInfo, code);
+        }
+        refCode << "\n";
+        appendIndented(refCode, code);
+    }
+
+    // @ref_code 中的代码内容未知，总是立即执行
+    if (!typesInfo.customRefCode.empty()) {
+        refCode << "\n";
+        appendIndented(refCode, std::string(typesInfo.customRefCode));
+    }
+}
+
+static std::string genRefFileCode(const TypesInfo &typesInfo, const FileReflecInfo &info)
+{
+    std::stringstream refCode;
+    refCode << "#include <gx/gany.h>\n";
+    for (const auto &include: genRefIncludes(typesInfo, info)) {
+        refCode << include << "\n";
+    }
+    refCode << "\n";
+
+    genRefUsingCode(refCode, typesInfo, "");
+
+    refCode << "\nvoid " << info.refFuncName << "()\n";
+    refCode << "{";
+    genRefFuncBody(refCode, typesInfo, info);
+    refCode << "}\n";
+
+    return refCode.str();
+}
+
+/**
+ * 分片中的反射函数，多个头文件共用一个翻译单元，using namespace 放在函数内，互不影响.
+ */
+static std::string genRefShardFuncCode(const TypesInfo &typesInfo, const FileReflecInfo &info)
+{
+    std::stringstream refCode;
+    refCode << "void " << info.refFuncName << "()\n";
+    refCode << "{\n";
+    genRefUsingCode(refCode, typesInfo, "    ");
+    genRefFuncBody(refCode, typesInfo, info);
+    refCode << "}\n";
+
+    return refCode.str();
+}
+
+/**
+ * 估算生成代码的模板实例化开销：每个 Class<T> 以及绑定的每个重载、属性、常量各实例化一组模板，
+ * 枚举另有 FromString 绑定.
+ * 枚举项是名字表中的一行，开销主要在编译期构建值索引和名字哈希，与项数大致成正比.
+ */
+static uint64_t estimateWeight(const TypesInfo &typesInfo)
+{
+    uint64_t weight = 1;
+    weight += 4 * typesInfo.classes.size();
+    weight += 5 * (typesInfo.enumClasses.size() + typesInfo.enums.size());
+    for (const auto &func: typesInfo.funcs) {
+        weight += func.overloads.size();
+    }
+    weight += typesInfo.properties.size();
+    for (const auto &classInfo: typesInfo.classes) {
+        weight += classInfo.constants.size();
+    }
+    weight += typesInfo.enumItems.size() / 8;
+    return weight;
+}
+
+static std::string shardFileName(uint32_t shard)
+{
+    return "ref_" + sModuleName + "_shard" + std::to_string(shard) + ".cpp";
+}
+
+static std::string outputFileName(const FileReflecInfo &info)
+{
+    return info.shard == ShardPlan::NO_SHARD ? info.refFileName : shardFileName(info.shard);
+}
+
+static void initReflecInfo(const GFile &file, FileReflecInfo &info)
+{
     const GString srcFilePath = file.absoluteFilePath();
     const GString srcFileNameWE = file.fileNameWithoutExtension();
-    const GString srcShortPath = srcFilePath.substring(sBasePath.size());
+    GString srcShortPath = srcFilePath.substring(sBasePath.size());
+    if (sDeterministic) {
+        srcShortPath = srcShortPath.replace("\\", "/");
+    }
 
     info.refFileName = "ref_" + srcFileNameWE.toStdString() + ".cpp";
     info.refFuncName = "ref_" + srcFileNameWE.toStdString();
+    info.srcShortPath = srcShortPath.toStdString();
+    info.stats = {};
+    info.stats.source = info.srcShortPath;
+}
 
-    std::stringstream refCode;
-    refCode << "#include <gx/gany.h>\n";
-    refCode << "#include <" << sIncludePrefix << srcShortPath << ">\n";
-    if (!typesInfo.includeFromSet.empty()) {
-        for (const auto &i : typesInfo.includeFromSet) {
-            refCode << "#include \"" << i << "\"\n";
+static std::string genRefFile(const TypesInfo &typesInfo, FileReflecInfo &info)
+{
+    FileStats &stats = info.stats;
+    stats.commentBlocks = typesInfo.commentBlockCount;
+    stats.classes = static_cast<uint32_t>(typesInfo.classes.size());
+    stats.enums = static_cast<uint32_t>(typesInfo.enumClasses.size() + typesInfo.enums.size());
+    stats.funcs = static_cast<uint32_t>(typesInfo.funcs.size());
+    stats.overloads = 0;
+    for (const auto &func: typesInfo.funcs) {
+        stats.overloads += static_cast<uint32_t>(func.overloads.size());
+    }
+
+    info.weight = estimateWeight(typesInfo);
+
+    ScopedTimer timer(stats.generateNs);
+    if (sShards > 0) {
+        info.refIncludes = genRefIncludes(typesInfo, info);
+        return genRefShardFuncCode(typesInfo, info);
+    }
+    return genRefFileCode(typesInfo, info);
+}
+
+static int32_t writeRefFile(const std::string &refCode, FileReflecInfo &info)
+{
+    const GFile outputFile(GFile(sOutput), info.refFileName);
+    OutputFile::WriteResult writeResult;
+    {
+        ScopedTimer timer(info.stats.writeNs);
+        writeResult = OutputFile::writeIfChanged(outputFile.absoluteFilePath(), refCode);
+    }
+    if (writeResult == OutputFile::WriteResult::Failed) {
+        LogE("Failed to write file: {}", outputFile.absoluteFilePath());
+        return -1;
+    }
+    info.stats.written = writeResult == OutputFile::WriteResult::Written;
+
+    return 1;
+}
+
+int32_t parseFile(const GFile &file, FileReflecInfo &info, bool allowSkip = true)
+{
+    MappedFile source;
+    if (!source.open(file.absoluteFilePath())) {
+        return -1;
+    }
+
+    initReflecInfo(file, info);
+    info.srcHash = BuildManifest::hashContent(source.view());
+    info.stats.bytes = source.view().size();
+
+    // 内容未变化且输出文件仍在，跳过解析与生成
+    if (sIncremental && allowSkip) {
+        const BuildManifest::Entry *entry = sPrevManifest.find(info.srcShortPath);
+        const std::string *typesRecord = sEmitTypes ? sPrevTypes.find(info.srcShortPath, info.srcHash) : nullptr;
+        if (entry && entry->hash == info.srcHash && GFile(GFile(sOutput), entry->output).exists()
+            && (!sEmitTypes || typesRecord)) {
+            info.weight = entry->weight;
+            info.typesRecord = typesRecord ? *typesRecord : std::string();
+            info.includes = entry->includes;
+            info.stats.skipped = true;
+            return 1;
         }
     }
-    refCode << "\n";
 
-    if (!typesInfo.cppNamespace.empty()) {
-        auto nss = GString(typesInfo.cppNamespace).split("::");
-        for (const auto &i : nss) {
-            refCode << "using namespace " << i << ";\n";
+    std::string refCode;
+    auto generate = [&](const TypesInfo &typesInfo) {
+        refCode = genRefFile(typesInfo, info);
+        info.includes.assign(typesInfo.includeFromSet.begin(), typesInfo.includeFromSet.end());
+        if (sEmitTypes) {
+            info.typesRecord = TypesManifest::serialize(typesInfo, info.srcShortPath, info.srcHash);
+        }
+    };
+    const std::string filePath = file.absoluteFilePath();
+    if (sHeaderCache && sHeaderCache->isShared(filePath)) {
+        // 批处理中被多个模块引用的头文件，解析结果由缓存持有
+        std::shared_ptr<const HeaderCache::Entry> cached;
+        {
+            ScopedTimer timer(info.stats.parseNs);
+            cached = sHeaderCache->get(filePath, info.srcHash, source.view());
         }
+        generate(*cached->typesInfo);
+    } else {
+        // 解析模型只在生成期间使用，离开作用域时整块释放
+        const TypesInfo typesInfo = [&] {
+            ScopedTimer timer(info.stats.parseNs);
+            return CppTypesInfoGen::parse(source.view());
+        }();
+        generate(typesInfo);
     }
 
-    for (const auto &uns: typesInfo.usingNameSpaces) {
-        if (typesInfo.cppNamespace != uns) {
-            refCode << "using namespace " << uns << ";\n";
+    // 分片模式下等分配好分片后统一写出
+    if (sShards > 0) {
+        info.refCode = std::move(refCode);
+        return 1;
+    }
+    return writeRefFile(refCode, info);
+}
+
+static BuildManifest makeManifest(uint64_t optionsHash, const std::vector<FileReflecInfo> &fileReflecInfos)
+{
+    BuildManifest manifest;
+    manifest.setKey(AUTOANY_VERSION, optionsHash);
+    for (const auto &refInfo: fileReflecInfos) {
+        manifest.set(refInfo.srcShortPath, {.hash = refInfo.srcHash, .weight = refInfo.weight, .output = outputFileName(refInfo), .includes = refInfo.includes});
+    }
+    return manifest;
+}
+
+static std::string lazyModuleHeaderName()
+{
+    return "reg_" + sModuleName + "_lazy.h";
+}
+
+/**
+ * 声明延迟注册模式下 reg_<Module>.cpp 提供的 require 函数，宿主代码包含后调用，不必手写原型.
+ */
+static std::string lazyModuleHeaderCode()
+{
+    std::string guard = "AUTOANY_REG_" + sModuleName + "_LAZY_H";
+    std::transform(guard.begin(), guard.end(), guard.begin(), [](unsigned char c) {
+        return std::isalnum(c) ? static_cast<char>(std::toupper(c)) : '_';
+    });
+
+    std::stringstream code;
+    code << "// Generated by autoany.\n\n";
+    code << "#ifndef " << guard << "\n";
+    code << "#define " << guard << "\n\n";
+    code << "#include <string>\n\n";
+    code << "// 模块以 --lazy 生成，加载时不注册任何类；脚本通过 GAny 导入或查找类之前，宿主需要先调用下面的函数\n\n";
+    code << "// 按 \"命名空间.类名\" 完成一个类的注册，没有登记的名字返回 false\n";
+    code << "bool " << sModuleName << "_RequireClass(const std::string &fullName);\n\n";
+    code << "// 完成模块中全部类的注册\n";
+    code << "void " << sModuleName << "_RequireAllClasses();\n\n";
+    code << "#endif // " << guard << "\n";
+    return code.str();
+}
+
+static bool writeModuleFile(const GFile &outputDir, const std::vector<FileReflecInfo> &fileReflecInfos)
+{
+    std::stringstream code;
+    code << "#include \"" << sIncludePrefix << "reg_" << sModuleName << ".h" << "\"\n";
+    code << "#include <gx/gany.h>\n";
+    if (sGenOptions.lazyRegistration) {
+        code << "#include \"" << ToAnyGen::LAZY_HEADER_FILE_NAME << "\"\n";
+        code << "#include \"" << lazyModuleHeaderName() << "\"\n";
+    }
+    if (sGenOptions.registrationProfile) {
+        code << "#include \"" << ToAnyGen::PROFILE_HEADER_FILE_NAME << "\"\n";
+    }
+    code << "\n";
+    for (const auto &refInfo: fileReflecInfos) {
+        code << "extern void " << refInfo.refFuncName << "();\n";
+    }
+    code << "\n";
+
+    code << "REGISTER_GANY_MODULE(" << sModuleName << ")\n";
+    code << "{\n";
+    for (const auto &refInfo: fileReflecInfos) {
+        if (sGenOptions.registrationProfile) {
+            code << "    {\n";
+            code << "        autoany::ScopedRegistrationTimer timer(" << ToAnyGen::formatString(sModuleName) << ", "
+                << ToAnyGen::formatString(refInfo.srcShortPath) << ", \"\");\n";
+            code << "        " << refInfo.refFuncName << "();\n";
+            code << "    }\n";
+        } else {
+            code << "    " << refInfo.refFuncName << "();\n";
         }
     }
+    if (sGenOptions.lazyRegistration) {
+        code << "    if (autoany::LazyClassTable::eagerRequested()) {\n";
+        code << "        autoany::LazyClassTable::instance().requireAll();\n";
+        code << "    }\n";
+    }
+    code << "}\n";
 
-    refCode << "using namespace gany;\n";
+    if (sGenOptions.lazyRegistration) {
+        code << "\n";
+        code << "bool " << sModuleName << "_RequireClass(const std::string &fullName)\n";
+        code << "{\n";
+        code << "    return autoany::LazyClassTable::instance().require(fullName);\n";
+        code << "}\n";
+        code << "\n";
+        code << "void " << sModuleName << "_RequireAllClasses()\n";
+        code << "{\n";
+        code << "    autoany::LazyClassTable::instance().requireAll();\n";
+        code << "}\n";
+    }
 
-    refCode << "\nvoid " << info.refFuncName << "()\n";
-    refCode << "{";
+    if (sGenOptions.registrationProfile) {
+        code << "\n";
+        code << "std::vector<AutoanyRegistrationSample> " << sModuleName << "_RegistrationProfile()\n";
+        code << "{\n";
+        code << "    return autoany::RegistrationProfile::instance().samples(\"" << sModuleName << "\");\n";
+        code << "}\n";
+        code << "\n";
+        code << "extern \"C\" AUTOANY_PROFILE_EXPORT size_t autoany_registration_profile_" << sModuleName
+            << "(const AutoanyRegistrationSample **samples)\n";
+        code << "{\n";
+        code << "    static std::vector<AutoanyRegistrationSample> snapshot;\n";
+        code << "    snapshot = " << sModuleName << "_RegistrationProfile();\n";
+        code << "    *samples = snapshot.data();\n";
+        code << "    return snapshot.size();\n";
+        code << "}\n";
+    }
 
-    for (const auto &enumInfo: typesInfo.enumClassInfos) {
-        std::string code = ToAnyGen::genReflecEnumClassCode(*enumInfo);
+    std::string headFileName = "reg_" + sModuleName + ".cpp";
+    const GFile moduleHeadFile(outputDir, headFileName);
+    if (OutputFile::writeIfChanged(moduleHeadFile.absoluteFilePath(), code.str()) == OutputFile::WriteResult::Failed) {
+        LogE("Failed to write file: {}", moduleHeadFile.absoluteFilePath());
+        return false;
+    }
+    return true;
+}
 
-        refCode << "\n";
+/**
+ * 写出生成代码引用的辅助头文件，对应选项关闭时删除上次留下的文件.
+ */
+static bool writeHelperHeader(const GFile &outputDir, const char *fileName, std::string_view code, bool enabled)
+{
+    const GFile headerFile(outputDir, fileName);
+    if (!enabled) {
+        if (headerFile.exists() && OutputFile::remove(headerFile.absoluteFilePath())) {
+            LogI("Remove stale file: {}", headerFile.absoluteFilePath());
+        }
+        return true;
+    }
+    if (OutputFile::writeIfChanged(headerFile.absoluteFilePath(), std::string(code)) == OutputFile::WriteResult::Failed) {
+        LogE("Failed to write file: {}", headerFile.absoluteFilePath());
+        return false;
+    }
+    return true;
+}
 
-        std::string line;
-        std::istringstream input(code);
-        while (std::getline(input, line)) {
-            if (line.empty()) {
-                refCode << "\n";
-                continue;
+/**
+ * 写出类型清单，未开启 --emit-manifest 时删除上次留下的文件.
+ */
+static bool writeTypesManifest(const GFile &outputDir, const std::vector<FileReflecInfo> &fileReflecInfos)
+{
+    const GFile typesFile(outputDir, TypesManifest::fileName(sModuleName));
+    if (!sEmitTypes) {
+        if (typesFile.exists() && OutputFile::remove(typesFile.absoluteFilePath())) {
+            LogI("Remove stale file: {}", typesFile.absoluteFilePath());
+        }
+        return true;
+    }
+    std::vector<std::string_view> records;
+    for (const auto &refInfo: fileReflecInfos) {
+        records.push_back(refInfo.typesRecord);
+    }
+    if (!TypesManifest::save(typesFile.absoluteFilePath(), AUTOANY_VERSION, sModuleName, records)) {
+        LogE("Failed to write file: {}", typesFile.absoluteFilePath());
+        return false;
+    }
+    return true;
+}
+
+static std::string depfileEscape(const std::string &path)
+{
+    std::string out;
+    for (const char ch: path) {
+        if (ch == ' ' || ch == '#') {
+            out.push_back('\\');
+        } else if (ch == '$') {
+            out.push_back('$');
+        }
+        out.push_back(ch);
+    }
+    return out;
+}
+
+/**
+ * @include_from 的路径写在生成的 ref 文件中，编译时按引号 include 查找，编译器的搜索路径未知，
+ * 依次尝试输出目录、基础路径（去掉 include 前缀）和源头文件所在目录，都找不到时不记录依赖.
+ */
+static std::string resolveInclude(const FileReflecInfo &info, const std::string &include)
+{
+    const std::filesystem::path basePath(sBasePath);
+    std::vector<std::filesystem::path> candidates;
+    candidates.push_back(std::filesystem::path(sOutput) / include);
+    if (!sIncludePrefix.empty() && include.starts_with(sIncludePrefix)) {
+        candidates.push_back(basePath / include.substr(sIncludePrefix.size()));
+    }
+    candidates.push_back(basePath / include);
+    candidates.push_back((basePath / info.srcShortPath).parent_path() / include);
+    for (const auto &candidate: candidates) {
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(candidate, ec)) {
+            return candidate.lexically_normal().string();
+        }
+    }
+    return {};
+}
+
+/**
+ * 写出 depfile：每个 ref 文件或分片一条规则，依赖其中各个头文件及它们的 @include_from.
+ */
+static bool writeDepfile(const GFile &outputDir, const std::vector<FileReflecInfo> &fileReflecInfos)
+{
+    if (sDepfile.empty()) {
+        return true;
+    }
+
+    std::map<std::string, std::set<std::string> > rules;
+    for (uint32_t k = 0; k < sShards; k++) {
+        rules[shardFileName(k)];
+    }
+    for (const auto &refInfo: fileReflecInfos) {
+        std::set<std::string> &deps = rules[outputFileName(refInfo)];
+        deps.insert(GFile(sBasePath + refInfo.srcShortPath).absoluteFilePath());
+        for (const auto &include: refInfo.includes) {
+            std::string path = resolveInclude(refInfo, include);
+            if (!path.empty()) {
+                deps.insert(std::move(path));
             }
-            refCode << "    " << line << "\n";
         }
     }
 
-    for (const auto &classInfo: typesInfo.classInfos) {
-        std::string code = ToAnyGen::genReflecClassCode(*classInfo);
+    std::stringstream code;
+    for (const auto &[output, deps]: rules) {
+        code << depfileEscape(GFile(outputDir, output).absoluteFilePath()) << ":";
+        for (const auto &dep: deps) {
+            code << " \\\n  " << depfileEscape(dep);
+        }
+        code << "\n";
+    }
 
-        refCode << "\n";
+    if (OutputFile::writeIfChanged(GFile(sDepfile).absoluteFilePath(), code.str()) == OutputFile::WriteResult::Failed) {
+        LogE("Failed to write depfile: {}", sDepfile);
+        return false;
+    }
+    return true;
+}
 
-        std::string line;
-        std::istringstream input(code);
-        while (std::getline(input, line)) {
-            if (line.empty()) {
-                refCode << "\n";
-                continue;
+static OutputFile::WriteResult writeShardFile(const GFile &outputDir, uint32_t shard, std::vector<const FileReflecInfo *> members)
+{
+    // 按源文件路径排序，分片内容与输入顺序无关
+    std::sort(members.begin(), members.end(), [](const FileReflecInfo *a, const FileReflecInfo *b) {
+        return a->srcShortPath < b->srcShortPath;
+    });
+
+    std::stringstream code;
+    code << "#include <gx/gany.h>\n";
+    std::unordered_set<std::string_view> included;
+    for (const FileReflecInfo *member: members) {
+        for (const auto &include: member->refIncludes) {
+            if (included.insert(include).second) {
+                code << include << "\n";
             }
-            refCode << "    " << line << "\n";
         }
     }
+    for (const FileReflecInfo *member: members) {
+        code << "\n" << member->refCode;
+    }
 
-    if (!typesInfo.customRefCode.empty()) {
-        refCode << "\n";
-        std::string line;
-        std::istringstream input(typesInfo.customRefCode);
-        while (std::getline(input, line)) {
-            if (line.empty()) {
-                refCode << "\n";
-                continue;
+    const GFile shardFile(outputDir, shardFileName(shard));
+    const auto result = OutputFile::writeIfChanged(shardFile.absoluteFilePath(), code.str());
+    if (result == OutputFile::WriteResult::Failed) {
+        LogE("Failed to write file: {}", shardFile.absoluteFilePath());
+    }
+    return result;
+}
+
+/**
+ * 分配分片并写出有变化的分片文件，空分片也会写出，输出文件集合只取决于分片数.
+ * 分片中有头文件变化、成员增减或分片文件缺失时，该分片内增量跳过的头文件需要重新解析生成.
+ */
+static bool writeShards(TaskPool &taskPool, const GFile &outputDir, const std::vector<GFile> &files, std::vector<FileReflecInfo> &infos)
+{
+    std::unordered_map<std::string, uint32_t> shardIndex;
+    for (uint32_t k = 0; k < sShards; k++) {
+        shardIndex[shardFileName(k)] = k;
+    }
+
+    std::vector<uint32_t> prevMemberCounts(sShards, 0);
+    if (sIncremental) {
+        for (const auto &[source, entry]: sPrevManifest.entries()) {
+            const auto it = shardIndex.find(entry.output);
+            if (it != shardIndex.end()) {
+                prevMemberCounts[it->second]++;
             }
-            refCode << "    " << line << "\n";
         }
     }
 
-    refCode << "}\n";
+    // --deterministic 时分配只取决于权重和输入，不沿用上一次的分片
+    std::vector<uint32_t> prevShards(infos.size(), ShardPlan::NO_SHARD);
+    std::vector<ShardPlan::Item> items(infos.size());
+    for (size_t i = 0; i < infos.size(); i++) {
+        const BuildManifest::Entry *entry = sIncremental ? sPrevManifest.find(infos[i].srcShortPath) : nullptr;
+        if (entry) {
+            const auto it = shardIndex.find(entry->output);
+            if (it != shardIndex.end()) {
+                prevShards[i] = it->second;
+            }
+        }
+        items[i].weight = infos[i].weight;
+        items[i].prevShard = sDeterministic ? ShardPlan::NO_SHARD : prevShards[i];
+    }
+    const std::vector<uint32_t> shards = ShardPlan::assign(items, sShards);
 
-    GFile outputFile(GFile(sOutput), info.refFileName);
-    if (outputFile.open(GFile::WriteOnly)) {
-        outputFile.write(refCode.str());
-        outputFile.close();
+    std::vector<char> dirty(sShards, 0);
+    std::vector<uint32_t> keptMemberCounts(sShards, 0);
+    for (size_t i = 0; i < infos.size(); i++) {
+        if (!infos[i].stats.skipped || prevShards[i] != shards[i]) {
+            dirty[shards[i]] = 1;
+        } else {
+            keptMemberCounts[shards[i]]++;
+        }
+    }
+    for (uint32_t k = 0; k < sShards; k++) {
+        if (keptMemberCounts[k] != prevMemberCounts[k] || !GFile(outputDir, shardFileName(k)).exists()) {
+            dirty[k] = 1;
+        }
     }
 
-    return 1;
+    std::vector<size_t> reparse;
+    for (size_t i = 0; i < infos.size(); i++) {
+        if (dirty[shards[i]] && infos[i].stats.skipped) {
+            reparse.push_back(i);
+        }
+    }
+    std::vector<int32_t> results(reparse.size(), 0);
+    taskPool.run(reparse.size(), [&](size_t index) {
+        results[index] = parseFile(files[reparse[index]], infos[reparse[index]], false);
+    });
+    for (size_t j = 0; j < reparse.size(); j++) {
+        if (results[j] < 0) {
+            LogE("Failed to generate reflection code, source file: {}", files[reparse[j]].absoluteFilePath());
+            return false;
+        }
+    }
+
+    std::vector<std::vector<const FileReflecInfo *> > members(sShards);
+    for (size_t i = 0; i < infos.size(); i++) {
+        infos[i].shard = shards[i];
+        members[shards[i]].push_back(&infos[i]);
+    }
+    std::vector<char> written(sShards, 0);
+    for (uint32_t k = 0; k < sShards; k++) {
+        if (!dirty[k]) {
+            continue;
+        }
+        const auto result = writeShardFile(outputDir, k, members[k]);
+        if (result == OutputFile::WriteResult::Failed) {
+            return false;
+        }
+        written[k] = result == OutputFile::WriteResult::Written;
+    }
+
+    for (auto &info: infos) {
+        info.stats.written = written[info.shard];
+        info.refIncludes = {};
+        info.refCode = {};
+    }
+    return true;
 }
 
-int main(int argc, char *argv[])
+/**
+ * --serve 模式下常驻内存的头文件，typesInfo 中的文本引用 source.
+ */
+struct ServedFile
 {
-    initGAnyCore();
+    GFile file;
+    std::string path; // 规范化后的绝对路径，用于匹配监视事件
+    FileReflecInfo info;
+    std::string source;
+    std::optional<TypesInfo> typesInfo;
+    std::filesystem::file_time_type mtime{};
+    uintmax_t size = 0;
+    bool present = false;
+};
 
-    const int optionIndex = handleArguments(argc, argv);
-    const int numArgs = argc - optionIndex;
-    if (numArgs < 1) {
-        printUsage(argv[0]);
-        return EXIT_FAILURE;
+/**
+ * 输入线程和监视线程投递给服务主循环的事件.
+ */
+struct ServeEvents
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::string> commands;
+    std::set<size_t> changed;
+    bool inputClosed = false;
+};
+
+static std::string normalizePath(const std::string &path)
+{
+    return std::filesystem::path(path).lexically_normal().string();
+}
+
+static bool statChanged(const ServedFile &served)
+{
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(served.path, ec);
+    const bool present = !ec;
+    if (present != served.present) {
+        return true;
+    }
+    return present && (mtime != served.mtime || std::filesystem::file_size(served.path, ec) != served.size);
+}
+
+/**
+ * 重新读取头文件，内容变化时重新解析并替换缓存的 TypesInfo.
+ * generate 为 true 时，内容变化或 ref 文件缺失会重新生成 ref 文件.
+ * 分片模式下只更新缓存的反射函数代码，由调用方写出受影响的分片.
+ */
+static bool refreshServedFile(ServedFile &served, bool generate)
+{
+    std::error_code ec;
+    served.mtime = std::filesystem::last_write_time(served.path, ec);
+    served.present = !ec;
+    if (!served.present) {
+        served.typesInfo.reset();
+        served.source.clear();
+        return true;
     }
+    served.size = std::filesystem::file_size(served.path, ec);
 
-    if (sOutput.empty()) {
-        printUsage(argv[0]);
-        return EXIT_FAILURE;
+    MappedFile mapped;
+    if (!mapped.open(served.path)) {
+        return false;
+    }
+    const uint64_t hash = BuildManifest::hashContent(mapped.view());
+    const bool changed = !served.typesInfo || hash != served.info.srcHash;
+    if (changed) {
+        // 先释放旧模型，再替换它引用的源码
+        served.typesInfo.reset();
+        served.source.assign(mapped.view());
+        served.info.srcHash = hash;
+        served.typesInfo.emplace(CppTypesInfoGen::parse(served.source));
+        served.info.includes.assign(served.typesInfo->includeFromSet.begin(), served.typesInfo->includeFromSet.end());
+        if (sEmitTypes) {
+            served.info.typesRecord = TypesManifest::serialize(*served.typesInfo, served.info.srcShortPath, hash);
+        }
     }
+    mapped.close();
 
-    if (sModuleName.empty()) {
-        printUsage(argv[0]);
-        return EXIT_FAILURE;
+    if (sShards > 0) {
+        if (changed) {
+            served.info.refCode = genRefFile(*served.typesInfo, served.info);
+        }
+        return true;
     }
+    if (!generate || (!changed && GFile(GFile(sOutput), served.info.refFileName).exists())) {
+        return true;
+    }
+    return writeRefFile(genRefFile(*served.typesInfo, served.info), served.info) >= 0;
+}
 
+static void serveReply(const std::string &message)
+{
+    // 应答以 '@' 开头，便于调用方与日志输出区分
+    fprintf(stdout, "@%s\n", message.c_str());
+    fflush(stdout);
+}
+
+static int serve(const std::vector<GFile> &inputFileLists, const std::vector<FileReflecInfo> &initialInfos,
+                 const GFile &outputDir, const std::string &manifestPath, uint64_t optionsHash)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr auto DEBOUNCE_TIME = std::chrono::milliseconds(30);
+    constexpr auto POLL_INTERVAL = std::chrono::milliseconds(500);
+
+    std::vector<std::unique_ptr<ServedFile> > files;
+    std::unordered_map<std::string, size_t> fileIndex;
+    for (size_t i = 0; i < inputFileLists.size(); i++) {
+        const GFile &f = inputFileLists[i];
+        auto served = std::make_unique<ServedFile>();
+        served->file = f;
+        served->path = normalizePath(f.absoluteFilePath());
+        initReflecInfo(f, served->info);
+        served->info.weight = initialInfos[i].weight;
+        served->info.shard = initialInfos[i].shard;
+        fileIndex[served->path] = files.size();
+        files.push_back(std::move(served));
+    }
+
+    TaskPool taskPool(std::min(sJobs, std::max<size_t>(files.size(), 1)), sJobServer.get());
+    taskPool.run(files.size(), [&](size_t index) {
+        refreshServedFile(*files[index], false);
+    });
+
+    // 变化的头文件留在原分片，重新出现的头文件放入最轻的分片，只重写成员有变化的分片
+    auto refreshShards = [&](const std::vector<size_t> &indices) {
+        std::vector<char> dirtyShards(sShards, 0);
+        for (const size_t index: indices) {
+            FileReflecInfo &info = files[index]->info;
+            if (info.shard != ShardPlan::NO_SHARD) {
+                dirtyShards[info.shard] = 1;
+            }
+            if (!files[index]->present) {
+                info.shard = ShardPlan::NO_SHARD;
+            }
+        }
+
+        std::vector<size_t> presentFiles;
+        std::vector<ShardPlan::Item> items;
+        for (size_t i = 0; i < files.size(); i++) {
+            if (files[i]->present) {
+                presentFiles.push_back(i);
+                items.push_back({.weight = files[i]->info.weight, .prevShard = sDeterministic ? ShardPlan::NO_SHARD : files[i]->info.shard});
+            }
+        }
+        const std::vector<uint32_t> shards = ShardPlan::assign(items, sShards);
+
+        std::vector<std::vector<const FileReflecInfo *> > members(sShards);
+        for (size_t j = 0; j < presentFiles.size(); j++) {
+            FileReflecInfo &info = files[presentFiles[j]]->info;
+            if (info.shard != shards[j]) {
+                if (info.shard != ShardPlan::NO_SHARD) {
+                    dirtyShards[info.shard] = 1;
+                }
+                dirtyShards[shards[j]] = 1;
+                info.shard = shards[j];
+            }
+            members[shards[j]].push_back(&info);
+        }
+
+        size_t failed = 0;
+        for (uint32_t k = 0; k < sShards; k++) {
+            if (dirtyShards[k] && writeShardFile(outputDir, k, members[k]) == OutputFile::WriteResult::Failed) {
+                failed++;
+            }
+        }
+        return failed;
+    };
+
+    // 重新生成有变化的文件；输入集合变化时更新模块文件，每轮都写回清单
+    auto refresh = [&](const std::set<size_t> &dirty) {
+        const std::vector<size_t> indices(dirty.begin(), dirty.end());
+        std::vector<char> wasPresent(indices.size());
+        std::vector<char> results(indices.size());
+        for (size_t i = 0; i < indices.size(); i++) {
+            wasPresent[i] = files[indices[i]]->present;
+        }
+        taskPool.run(indices.size(), [&](size_t i) {
+            results[i] = refreshServedFile(*files[indices[i]], true);
+        });
+
+        size_t failed = 0;
+        bool setChanged = false;
+        for (size_t i = 0; i < indices.size(); i++) {
+            const ServedFile &served = *files[indices[i]];
+            if (!results[i]) {
+                LogE("Failed to generate reflection code, source file: {}", served.path);
+                failed++;
+            }
+            if (wasPresent[i] != served.present) {
+                setChanged = true;
+                if (!served.present && sShards == 0) {
+                    OutputFile::remove(GFile(outputDir, served.info.refFileName).absoluteFilePath());
+                }
+            }
+        }
+
+        if (sShards > 0) {
+            failed += refreshShards(indices);
+        }
+
+        std::vector<FileReflecInfo> fileReflecInfos;
+        for (const auto &served: files) {
+            if (served->present) {
+                fileReflecInfos.push_back(served->info);
+            }
+        }
+        if (setChanged && !fileReflecInfos.empty() && !writeModuleFile(outputDir, fileReflecInfos)) {
+            failed++;
+        }
+        if (!makeManifest(optionsHash, fileReflecInfos).save(manifestPath)) {
+            LogW("Failed to write manifest: {}", manifestPath);
+        }
+        if (!writeTypesManifest(outputDir, fileReflecInfos) || !writeDepfile(outputDir, fileReflecInfos)) {
+            failed++;
+        }
+        return failed;
+    };
+
+    auto scanChanged = [&](std::set<size_t> &dirty) {
+        for (size_t i = 0; i < files.size(); i++) {
+            if (statChanged(*files[i])) {
+                dirty.insert(i);
+            }
+        }
+    };
+
+    const auto events = std::make_shared<ServeEvents>();
+
+    FileWatcher watcher;
+    std::string watchDir = sBasePath;
+    while (watchDir.size() > 1 && watchDir.back() == '/') {
+        watchDir.pop_back();
+    }
+    const bool watching = watcher.start(watchDir, [&fileIndex, fileCount = files.size(), events](const std::string &path) {
+        if (path.empty()) {
+            // 事件队列溢出，所有输入都可能有变化，刷新时按内容哈希跳过没有变化的文件
+            std::lock_guard lock(events->mutex);
+            for (size_t i = 0; i < fileCount; i++) {
+                events->changed.insert(i);
+            }
+            events->cond.notify_one();
+            return;
+        }
+        const auto it = fileIndex.find(normalizePath(path));
+        if (it == fileIndex.end()) {
+            return;
+        }
+        std::lock_guard lock(events->mutex);
+        events->changed.insert(it->second);
+        events->cond.notify_one();
+    });
+    if (!watching) {
+        LogW("File watching is not available, polling inputs every {} ms", POLL_INTERVAL.count());
+    }
+
+    // 标准输入可能一直阻塞在读取上，线程与主循环只共享 events
+    std::thread([events] {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            std::lock_guard lock(events->mutex);
+            events->commands.push_back(std::move(line));
+            events->cond.notify_one();
+        }
+        std::lock_guard lock(events->mutex);
+        events->inputClosed = true;
+        events->cond.notify_one();
+    }).detach();
+
+    serveReply("ready");
+
+    std::set<size_t> pending;
+    std::optional<Clock::time_point> refreshDeadline;
+    Clock::time_point nextPoll = Clock::now() + POLL_INTERVAL;
+    size_t lastFailed = 0;
+
+    auto currentState = [&] {
+        return lastFailed == 0 ? std::string("current") : "failed " + std::to_string(lastFailed);
+    };
+
+    while (true) {
+        std::deque<std::string> commands;
+        bool inputClosed;
+        {
+            std::unique_lock lock(events->mutex);
+            Clock::time_point wakeTime = refreshDeadline.value_or(Clock::now() + std::chrono::hours(1));
+            if (!watching) {
+                wakeTime = std::min(wakeTime, nextPoll);
+            }
+            events->cond.wait_until(lock, wakeTime, [&] {
+                return !events->commands.empty() || !events->changed.empty() || events->inputClosed;
+            });
+            commands.swap(events->commands);
+            pending.insert(events->changed.begin(), events->changed.end());
+            events->changed.clear();
+            inputClosed = events->inputClosed;
+        }
+
+        const auto now = Clock::now();
+        if (!watching && now >= nextPoll) {
+            scanChanged(pending);
+            nextPoll = now + POLL_INTERVAL;
+        }
+
+        // 编辑器保存时往往连续产生多个事件，稍作等待后一起处理
+        if (!pending.empty() && !refreshDeadline) {
+            refreshDeadline = now + DEBOUNCE_TIME;
+        }
+        if (refreshDeadline && now >= *refreshDeadline) {
+            lastFailed = refresh(pending);
+            pending.clear();
+            refreshDeadline.reset();
+        }
+
+        for (const auto &line: commands) {
+            const std::string_view command = SourceLexer::trim(line);
+            if (command.empty()) {
+                continue;
+            }
+            if (command == "status") {
+                std::set<size_t> dirty = pending;
+                scanChanged(dirty);
+                serveReply(dirty.empty() ? currentState() : "pending " + std::to_string(dirty.size()));
+            } else if (command == "wait") {
+                // 监视事件可能还没送达，按文件状态再核对一遍
+                scanChanged(pending);
+                if (!pending.empty()) {
+                    lastFailed = refresh(pending);
+                    pending.clear();
+                    refreshDeadline.reset();
+                }
+                serveReply(currentState());
+            } else if (command == "quit") {
+                serveReply("bye");
+                return EXIT_SUCCESS;
+            } else {
+                serveReply("error unknown command: " + std::string(command));
+            }
+        }
+
+        if (inputClosed) {
+            return EXIT_SUCCESS;
+        }
+    }
+}
+
+/**
+ * 解析生成全部输入并写出输出目录中的文件，fileLists 和 fileReflecInfos 按生成顺序返回参与生成的头文件.
+ * --deterministic 时输入按源文件路径排序去重，输出与命令行中的顺序无关.
+ */
+static bool generateModule(TaskPool &taskPool, std::vector<GFile> inputFileLists, const GFile &outputDir, uint64_t optionsHash,
+                           std::vector<GFile> &fileLists, std::vector<FileReflecInfo> &fileReflecInfos)
+{
+    if (sDeterministic) {
+        std::sort(inputFileLists.begin(), inputFileLists.end(), [](const GFile &a, const GFile &b) {
+            return a.absoluteFilePath() < b.absoluteFilePath();
+        });
+        inputFileLists.erase(std::unique(inputFileLists.begin(), inputFileLists.end(), [](const GFile &a, const GFile &b) {
+            return a.absoluteFilePath() == b.absoluteFilePath();
+        }), inputFileLists.end());
+    }
+    const std::string manifestPath = GFile(outputDir, BuildManifest::FILE_NAME).absoluteFilePath();
+
+    // 各个头文件互相独立，并行解析生成，结果按输入顺序合并，保证模块文件与串行运行一致
+    std::vector<FileReflecInfo> parsedInfos(inputFileLists.size());
+    std::vector<int32_t> parseResults(inputFileLists.size(), 0);
+
+    taskPool.run(inputFileLists.size(), [&](size_t index) {
+        parseResults[index] = parseFile(inputFileLists[index], parsedInfos[index]);
+    });
+
+    for (size_t i = 0; i < inputFileLists.size(); i++) {
+        const int32_t ret = parseResults[i];
+        if (ret < 0) {
+            LogE("Failed to generate reflection code, source file: {}", inputFileLists[i].absoluteFilePath());
+            return false;
+        }
+        if (ret == 1) {
+            fileLists.push_back(inputFileLists[i]);
+            fileReflecInfos.push_back(std::move(parsedInfos[i]));
+        }
+    }
+
+    if (sShards > 0 && !writeShards(taskPool, outputDir, fileLists, fileReflecInfos)) {
+        return false;
+    }
+
+    const BuildManifest manifest = makeManifest(optionsHash, fileReflecInfos);
+    std::unordered_set<std::string> outputFileNames;
+    for (const auto &refInfo: fileReflecInfos) {
+        outputFileNames.insert(outputFileName(refInfo));
+    }
+    for (uint32_t k = 0; k < sShards; k++) {
+        outputFileNames.insert(shardFileName(k));
+    }
+
+    // 删除上次生成、但这次不再输出的 ref 文件和分片文件
+    for (const auto &[source, entry]: sPrevManifest.entries()) {
+        if (entry.output.empty() || outputFileNames.contains(entry.output)) {
+            continue;
+        }
+        const GFile staleFile(outputDir, entry.output);
+        if (staleFile.exists() && OutputFile::remove(staleFile.absoluteFilePath())) {
+            LogI("Remove stale file: {}", staleFile.absoluteFilePath());
+        }
+    }
+    // 分片数减少后多出的空分片不在清单中，按序号逐个清理
+    for (uint32_t k = sShards; GFile(outputDir, shardFileName(k)).exists(); k++) {
+        const GFile staleFile(outputDir, shardFileName(k));
+        if (OutputFile::remove(staleFile.absoluteFilePath())) {
+            LogI("Remove stale file: {}", staleFile.absoluteFilePath());
+        } else {
+            break;
+        }
+    }
+    if (!manifest.save(manifestPath)) {
+        LogW("Failed to write manifest: {}", manifestPath);
+    }
+
+    // 生成模块源文件和生成代码引用的辅助头文件
+    if (!fileReflecInfos.empty() && !writeModuleFile(outputDir, fileReflecInfos)) {
+        return false;
+    }
+    if (!writeHelperHeader(outputDir, ToAnyGen::ENUM_HEADER_FILE_NAME, ToAnyGen::enumHeaderCode(), true)
+        || !writeHelperHeader(outputDir, ToAnyGen::LAZY_HEADER_FILE_NAME, ToAnyGen::lazyHeaderCode(), sGenOptions.lazyRegistration)
+        || !writeHelperHeader(outputDir, lazyModuleHeaderName().c_str(), lazyModuleHeaderCode(), sGenOptions.lazyRegistration)
+        || !writeHelperHeader(outputDir, ToAnyGen::TABLE_HEADER_FILE_NAME, ToAnyGen::tableHeaderCode(), sGenOptions.registrationTables)
+        || !writeHelperHeader(outputDir, ToAnyGen::PROFILE_HEADER_FILE_NAME, ToAnyGen::profileHeaderCode(), sGenOptions.registrationProfile)) {
+        return false;
+    }
+    if (!fileReflecInfos.empty() && !writeTypesManifest(outputDir, fileReflecInfos)) {
+        return false;
+    }
+    if (!writeDepfile(outputDir, fileReflecInfos)) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * 把目录中每个文件的内容摘要按文件名收集.
+ */
+static std::map<std::string, uint64_t> digestFiles(const std::filesystem::path &dir)
+{
+    std::map<std::string, uint64_t> digests;
+    std::error_code ec;
+    for (const auto &entry: std::filesystem::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        MappedFile mapped;
+        if (mapped.open(entry.path().string())) {
+            digests[entry.path().filename().string()] = BuildManifest::hashContent(mapped.view());
+        }
+    }
+    return digests;
+}
+
+/**
+ * --self-check：不使用增量状态，把同样的输入再生成一遍到临时目录，逐个比较两次输出的摘要.
+ * --self-check 隐含 --deterministic，两次的分片只取决于权重；输出目录不同，也检验输出中不含主机路径.
+ */
+static bool selfCheck(TaskPool &taskPool, std::vector<GFile> inputFileLists, const GFile &outputDir, uint64_t optionsHash)
+{
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    const std::filesystem::path checkDir = std::filesystem::temp_directory_path()
+                                           / ("autoany-self-check-" + sModuleName + "-" + std::to_string(stamp));
+    std::error_code ec;
+    std::filesystem::create_directories(checkDir, ec);
+
+    // 第二次生成使用全新的状态，不读上一次的清单，也不写 depfile
+    const std::string output = sOutput;
+    const std::string depfile = sDepfile;
+    const bool incremental = sIncremental;
+    BuildManifest prevManifest = std::move(sPrevManifest);
+    TypesManifest prevTypes = std::move(sPrevTypes);
+    sPrevManifest = {};
+    sPrevTypes = {};
+    sOutput = GFile(checkDir.string()).absoluteFilePath() + "/";
+    sDepfile.clear();
+    sIncremental = false;
+
+    std::vector<GFile> fileLists;
+    std::vector<FileReflecInfo> fileReflecInfos;
+    bool passed = generateModule(taskPool, std::move(inputFileLists), GFile(sOutput), optionsHash, fileLists, fileReflecInfos);
+
+    sOutput = output;
+    sDepfile = depfile;
+    sIncremental = incremental;
+    sPrevManifest = std::move(prevManifest);
+    sPrevTypes = std::move(prevTypes);
+
+    if (passed) {
+        const auto expected = digestFiles(std::filesystem::path(outputDir.absoluteFilePath()));
+        const auto actual = digestFiles(checkDir);
+        for (const auto &[name, digest]: actual) {
+            const auto it = expected.find(name);
+            if (it == expected.end() || it->second != digest) {
+                LogE("Self-check failed, output differs between runs: {}", name);
+                passed = false;
+            }
+        }
+        if (passed) {
+            LogI("Self-check passed: {} files identical", actual.size());
+        }
+    } else {
+        LogE("Self-check failed, the second generation did not complete");
+    }
+
+    std::filesystem::remove_all(checkDir, ec);
+    return passed;
+}
+
+/**
+ * 生成一个模块，模块名、路径等选项取自当前的全局设置.
+ * sharedPool 为空时按输入数量创建工作池.
+ */
+static int runModule(const std::vector<std::string> &inputs, TaskPool *sharedPool, RunStats &runStats)
+{
     //
     const GFile baseDir(sBasePath);
     if (!baseDir.isDirectory()) {
@@ -278,13 +1542,72 @@ int main(int argc, char *argv[])
     sOutput = outputDir.absoluteFilePath() + "/";
 
     //
+    std::string optionsKey = sModuleName;
+    optionsKey.push_back('\0');
+    // 输出与基础路径的位置无关，--deterministic 时清单也不随检出目录变化
+    if (!sDeterministic) {
+        optionsKey.append(sBasePath);
+    }
+    optionsKey.push_back('\0');
+    optionsKey.append(sIncludePrefix);
+    optionsKey.push_back('\0');
+    optionsKey.append(std::to_string(sShards));
+    optionsKey.push_back('\0');
+    optionsKey.push_back(sGenOptions.arityDispatch ? '1' : '0');
+    optionsKey.push_back(sGenOptions.lazyRegistration ? '1' : '0');
+    optionsKey.push_back(sGenOptions.registrationTables ? '1' : '0');
+    optionsKey.push_back(sGenOptions.registrationProfile ? '1' : '0');
+    optionsKey.push_back(sDeterministic ? '1' : '0');
+    const uint64_t optionsHash = BuildManifest::hashContent(optionsKey);
+
+    const std::string manifestPath = GFile(outputDir, BuildManifest::FILE_NAME).absoluteFilePath();
+    if (sPrevManifest.load(manifestPath)) {
+        sIncremental = !sForce && sPrevManifest.isCompatible(AUTOANY_VERSION, optionsHash);
+    }
+    if (sEmitTypes && sIncremental) {
+        sPrevTypes.load(GFile(outputDir, TypesManifest::fileName(sModuleName)).absoluteFilePath(), AUTOANY_VERSION);
+    }
+
+    // 扫描目录时文件数在遍历前未知，按 -j 创建工作线程
+    std::optional<TaskPool> localPool;
+    const size_t maxTasks = sScanDir.empty() ? std::max<size_t>(inputs.size(), 1) : sJobs;
+    TaskPool &taskPool = sharedPool ? *sharedPool : localPool.emplace(std::min(sJobs, maxTasks), sJobServer.get());
+
+    std::vector<std::string> inputPaths = inputs;
+    if (!sScanDir.empty()) {
+        const std::string scanDir = GFile(sScanDir).absoluteFilePath() + "/";
+        if (!GFile(sScanDir).isDirectory() || !scanDir.starts_with(sBasePath)) {
+            LogE("The scan path is not a directory under the base path: {}", sScanDir);
+            return EXIT_FAILURE;
+        }
+        static const std::vector<std::string> DEFAULT_INCLUDE_GLOBS = {"*.h", "*.hpp"};
+        const InputScan::Result scanResult = InputScan::scan(taskPool, scanDir, sIncludeGlobs.empty() ? DEFAULT_INCLUDE_GLOBS : sIncludeGlobs,
+                                                             sExcludeGlobs);
+        inputPaths.insert(inputPaths.end(), scanResult.files.begin(), scanResult.files.end());
+        if (sStats && sStatsFormat == RunStats::Format::Text) {
+            printf("scan: %zu files, %zu matched, %zu with reflection tags\n",
+                   scanResult.visited, scanResult.matched, scanResult.files.size());
+        }
+    }
+
+    // 每个输入的 stat 和绝对路径并行求出，数万个头文件时不再逐个串行访问文件系统
+    std::vector<GFile> candidateFiles(inputPaths.begin(), inputPaths.end());
+    std::vector<std::string> absolutePaths(candidateFiles.size());
+    std::vector<char> exists(candidateFiles.size(), 0);
+    taskPool.run(candidateFiles.size(), [&](size_t index) {
+        exists[index] = candidateFiles[index].exists();
+        if (exists[index]) {
+            absolutePaths[index] = candidateFiles[index].absoluteFilePath();
+        }
+    });
+
     std::vector<GFile> inputFileLists;
-    for (int argIndex = optionIndex; argIndex < argc; ++argIndex) {
-        GFile f(argv[argIndex]);
-        if (!f.exists()) {
+    for (size_t i = 0; i < candidateFiles.size(); ++i) {
+        const GFile &f = candidateFiles[i];
+        if (!exists[i]) {
             continue;
         }
-        if (!f.absoluteFilePath().starts_with(sBasePath)) {
+        if (!absolutePaths[i].starts_with(sBasePath)) {
             LogE("The file is not under the base path: {}", f.filePath());
             continue;
         }
@@ -295,43 +1618,222 @@ int main(int argc, char *argv[])
         inputFileLists.push_back(f);
     }
 
+    std::vector<GFile> fileLists;
     std::vector<FileReflecInfo> fileReflecInfos;
-    for (GFile &file: inputFileLists) {
-        FileReflecInfo info{};
-        const int32_t ret = parseFile(file, info);
-        if (ret < 0) {
-            LogE("Failed to generate reflection code, source file: {}", file.absoluteFilePath());
-            return EXIT_FAILURE;
+    if (!generateModule(taskPool, inputFileLists, outputDir, optionsHash, fileLists, fileReflecInfos)) {
+        return EXIT_FAILURE;
+    }
+    if (sSelfCheck && !selfCheck(taskPool, inputFileLists, outputDir, optionsHash)) {
+        return EXIT_FAILURE;
+    }
+
+    if (sStats) {
+        for (const auto &refInfo: fileReflecInfos) {
+            runStats.addFile(refInfo.stats);
         }
-        if (ret == 1) {
-            fileReflecInfos.push_back(info);
+        const std::string report = runStats.format(sStatsFormat, AUTOANY_VERSION, sModuleName, taskPool.threadCount());
+        if (sStatsFormat == RunStats::Format::Json) {
+            const GFile statsFile(outputDir, "autoany.stats.json");
+            if (OutputFile::writeIfChanged(statsFile.absoluteFilePath(), report) == OutputFile::WriteResult::Failed) {
+                LogW("Failed to write stats: {}", statsFile.absoluteFilePath());
+            }
+        } else {
+            fputs(report.c_str(), stdout);
         }
     }
 
-    // 生成模块源文件
-    if (!fileReflecInfos.empty()) {
-        std::stringstream code;
-        code << "#include \"" << sIncludePrefix << "reg_" << sModuleName << ".h" << "\"\n";
-        code << "#include <gx/gany.h>\n\n";
-        for (const auto &refInfo: fileReflecInfos) {
-            code << "extern void " << refInfo.refFuncName << "();\n";
+    if (sServe) {
+        return serve(fileLists, fileReflecInfos, outputDir, manifestPath, optionsHash);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * 批处理文件中的一个模块.
+ */
+struct BatchModule
+{
+    std::string moduleName;
+    std::string basePath;
+    std::string includePrefix;
+    std::string output;
+    std::string depfile;
+    std::vector<std::string> inputs;
+};
+
+/**
+ * 每个模块从 module 行开始，其余各行为 "键 值"，空行和 # 开头的行忽略：
+ *     module Gx
+ *     base-path include/gx
+ *     include-prefix gx/
+ *     output build/gx/toany
+ *     depfile build/gx/toany/Gx.d
+ *     input include/gx/a.h
+ *     input @build/gx/headers.txt
+ */
+static bool loadBatchFile(const std::string &filePath, std::vector<BatchModule> &modules)
+{
+    GFile file(filePath);
+    if (!file.exists() || !file.open(GFile::ReadOnly)) {
+        LogE("Failed to read batch file: {}", filePath);
+        return false;
+    }
+    const std::string content = file.readAll().toStdString();
+    file.close();
+
+    std::istringstream input(content);
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        const std::string_view text = SourceLexer::trim(line);
+        if (text.empty() || text.starts_with('#')) {
+            continue;
         }
-        code << "\n";
+        const size_t space = text.find_first_of(" \t");
+        const std::string_view key = text.substr(0, space);
+        const std::string value(space == std::string_view::npos ? std::string_view{} : SourceLexer::trim(text.substr(space)));
 
-        code << "REGISTER_GANY_MODULE(" << sModuleName << ")\n";
-        code << "{\n";
-        for (const auto &refInfo: fileReflecInfos) {
-            code << "    " << refInfo.refFuncName << "();\n";
+        if (key == "module") {
+            modules.emplace_back().moduleName = value;
+            continue;
         }
-        code << "}\n";
+        if (modules.empty()) {
+            LogE("{}:{}: expected a module line first", filePath, lineNumber);
+            return false;
+        }
+        BatchModule &module = modules.back();
+        if (key == "base-path") {
+            module.basePath = value;
+        } else if (key == "include-prefix") {
+            module.includePrefix = value;
+        } else if (key == "output") {
+            module.output = value;
+        } else if (key == "depfile") {
+            module.depfile = value;
+        } else if (key == "input") {
+            module.inputs.push_back(value);
+        } else {
+            LogE("{}:{}: unknown key: {}", filePath, lineNumber, std::string(key));
+            return false;
+        }
+    }
 
-        std::string headFileName = "reg_" + sModuleName + ".cpp";
-        GFile moduleHeadFile(outputDir, headFileName);
-        if (moduleHeadFile.open(GFile::WriteOnly)) {
-            moduleHeadFile.write(code.str());
-            moduleHeadFile.close();
+    for (auto &module: modules) {
+        std::vector<std::string> inputs;
+        std::string failedFile;
+        if (!InputScan::expandResponseFiles(module.inputs, inputs, failedFile)) {
+            LogE("Failed to read response file: {}", failedFile);
+            return false;
+        }
+        module.inputs = std::move(inputs);
+        if (module.moduleName.empty() || module.basePath.empty() || module.output.empty() || module.inputs.empty()) {
+            LogE("Batch module requires module, base-path, output and at least one input: {}", module.moduleName);
+            return false;
         }
     }
+    return !modules.empty();
+}
 
-    return EXIT_SUCCESS;
+/**
+ * --batch：在一个进程中依次生成多个模块，共用一个工作池，被多个模块引用的头文件只解析一次.
+ * 命令行上的其余选项对所有模块生效，每个模块的输出与单独运行一致.
+ */
+static int runBatch(const std::string &batchFile)
+{
+    std::vector<BatchModule> modules;
+    if (!loadBatchFile(batchFile, modules)) {
+        return EXIT_FAILURE;
+    }
+
+    HeaderCache headerCache;
+    std::unordered_map<std::string, uint32_t> moduleCounts;
+    size_t maxInputs = 1;
+    for (const auto &module: modules) {
+        std::unordered_set<std::string> paths;
+        for (const auto &input: module.inputs) {
+            const std::string path = GFile(input).absoluteFilePath();
+            if (paths.insert(path).second && ++moduleCounts[path] == 2) {
+                headerCache.share(path);
+            }
+        }
+        maxInputs = std::max(maxInputs, module.inputs.size());
+    }
+    sHeaderCache = &headerCache;
+
+    TaskPool taskPool(std::min(sJobs, maxInputs), sJobServer.get());
+    int result = EXIT_SUCCESS;
+    for (const auto &module: modules) {
+        // 每个模块从命令行的设置开始，不带上一个模块的状态
+        sModuleName = module.moduleName;
+        sBasePath = module.basePath;
+        sIncludePrefix = module.includePrefix;
+        sOutput = module.output;
+        sDepfile = module.depfile;
+        sIncremental = false;
+        sPrevTypes = {};
+
+        RunStats runStats;
+        if (runModule(module.inputs, &taskPool, runStats) != EXIT_SUCCESS) {
+            LogE("Failed to generate module: {}", module.moduleName);
+            result = EXIT_FAILURE;
+            break;
+        }
+    }
+    sHeaderCache = nullptr;
+
+    if (sStats) {
+        printf("batch: %zu modules, %zu shared headers, %llu parses reused\n",
+               modules.size(), static_cast<size_t>(std::count_if(moduleCounts.begin(), moduleCounts.end(), [](const auto &it) {
+                   return it.second > 1;
+               })), static_cast<unsigned long long>(headerCache.hits()));
+    }
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    RunStats runStats;
+
+    initGAnyCore();
+
+    const int optionIndex = handleArguments(argc, argv);
+
+    // 在并行 make 中由 jobserver 的令牌限制并行度，未指定 -j 时按硬件线程数创建工作线程
+    sJobServer = JobServer::fromEnvironment();
+    if (sJobServer && !sJobsSet) {
+        sJobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    if (!sBatchFile.empty()) {
+        if (sServe || optionIndex < argc || !sScanDir.empty()) {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        return runBatch(sBatchFile);
+    }
+
+    std::vector<std::string> inputs;
+    std::string failedFile;
+    if (!InputScan::expandResponseFiles(std::vector<std::string>(argv + optionIndex, argv + argc), inputs, failedFile)) {
+        LogE("Failed to read response file: {}", failedFile);
+        return EXIT_FAILURE;
+    }
+    if (inputs.empty() && sScanDir.empty()) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (sOutput.empty()) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (sModuleName.empty()) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    return runModule(inputs, nullptr, runStats);
 }
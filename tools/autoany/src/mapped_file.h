@@ -0,0 +1,45 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+
+
+/**
+ * 只读内存映射的输入文件，解析阶段直接在映射上工作，避免整文件拷贝.
+ * 空文件不做映射，view() 返回空串.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &filePath);
+
+    void close();
+
+    std::string_view view() const
+    {
+        return {mData, mSize};
+    }
+
+private:
+    const char *mData = nullptr;
+    size_t mSize = 0;
+#if defined(_WIN32)
+    void *mFileHandle = nullptr;
+    void *mMappingHandle = nullptr;
+#endif
+};
+
+#endif //MAPPED_FILE_H
@@ -0,0 +1,70 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "output_file.h"
+
+#include <gx/gfile.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+
+static bool sameAsOnDisk(const std::string &filePath, const std::string &content)
+{
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(filePath, ec);
+    if (ec || size != content.size()) {
+        return false;
+    }
+
+    GFile file(filePath);
+    if (!file.open(GFile::ReadOnly)) {
+        return false;
+    }
+    const std::string old = file.readAll().toStdString();
+    file.close();
+    return old == content;
+}
+
+OutputFile::WriteResult OutputFile::writeIfChanged(const std::string &filePath, const std::string &content)
+{
+    if (sameAsOnDisk(filePath, content)) {
+        return WriteResult::Unchanged;
+    }
+
+    static std::atomic<uint32_t> sTempCounter{0};
+    const std::string tempPath = filePath + ".tmp"
+                                 + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()) & 0xffff)
+                                 + "_" + std::to_string(sTempCounter++);
+
+    // 写入或关闭失败（磁盘满、短写）时不重命名，保留原来的输出
+    std::error_code ec;
+    std::ofstream tempFile(std::filesystem::path(tempPath), std::ios::binary | std::ios::trunc);
+    if (!tempFile) {
+        return WriteResult::Failed;
+    }
+    tempFile.write(content.data(), static_cast<std::streamsize>(content.size()));
+    tempFile.close();
+    if (tempFile.fail()) {
+        std::filesystem::remove(tempPath, ec);
+        return WriteResult::Failed;
+    }
+
+    std::filesystem::rename(tempPath, filePath, ec);
+    if (ec) {
+        std::filesystem::remove(tempPath, ec);
+        return WriteResult::Failed;
+    }
+    return WriteResult::Written;
+}
+
+bool OutputFile::remove(const std::string &filePath)
+{
+    std::error_code ec;
+    return std::filesystem::remove(filePath, ec);
+}
@@ -0,0 +1,32 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef OUTPUT_FILE_H
+#define OUTPUT_FILE_H
+
+#include <string>
+
+
+/**
+ * 生成文件的写出工具.
+ * 内容与磁盘上一致时不重写，保持 mtime 不变，避免构建系统重新编译生成的代码；
+ * 内容变化时先写临时文件再原子重命名，并行构建不会读到写了一半的文件.
+ */
+class OutputFile
+{
+public:
+    enum class WriteResult
+    {
+        Unchanged,
+        Written,
+        Failed,
+    };
+
+public:
+    static WriteResult writeIfChanged(const std::string &filePath, const std::string &content);
+
+    static bool remove(const std::string &filePath);
+};
+
+#endif //OUTPUT_FILE_H
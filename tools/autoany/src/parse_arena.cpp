@@ -0,0 +1,27 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "parse_arena.h"
+
+#include <cstring>
+
+
+ParseArena::ParseArena(size_t initialSize)
+    : mResource(initialSize),
+      mStrings(&mResource)
+{
+}
+
+std::string_view ParseArena::intern(std::string_view str)
+{
+    if (str.empty()) {
+        return {};
+    }
+    if (const auto it = mStrings.find(str); it != mStrings.end()) {
+        return *it;
+    }
+    char *data = static_cast<char *>(mResource.allocate(str.size(), alignof(char)));
+    std::memcpy(data, str.data(), str.size());
+    return *mStrings.emplace(data, str.size()).first;
+}
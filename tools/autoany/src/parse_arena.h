@@ -0,0 +1,43 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef PARSE_ARENA_H
+#define PARSE_ARENA_H
+
+#include <memory_resource>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+
+template<typename T>
+using ArenaVector = std::pmr::vector<T>;
+
+/**
+ * 单个头文件解析期间使用的内存区，解析模型中的容器和合成的字符串都从这里分配.
+ * 只分配不释放，随 TypesInfo 析构整块归还.
+ * 合成的字符串做驻留，相同内容只保存一份，返回的 string_view 在内存区生命周期内有效.
+ */
+class ParseArena
+{
+public:
+    explicit ParseArena(size_t initialSize = 4096);
+
+    ParseArena(const ParseArena &) = delete;
+
+    ParseArena &operator=(const ParseArena &) = delete;
+
+    std::pmr::memory_resource *resource()
+    {
+        return &mResource;
+    }
+
+    std::string_view intern(std::string_view str);
+
+private:
+    std::pmr::monotonic_buffer_resource mResource;
+    std::pmr::unordered_set<std::string_view> mStrings;
+};
+
+#endif //PARSE_ARENA_H
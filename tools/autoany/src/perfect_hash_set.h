@@ -0,0 +1,91 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef PERFECT_HASH_SET_H
+#define PERFECT_HASH_SET_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+
+/**
+ * 编译期构建的字符串完美哈希集合，适用于固定的小关键字表.
+ * 构造时搜索一个使所有关键字互不冲突的种子，查找只需一次哈希和一次比较.
+ * indexOf 返回关键字在构造数组中的下标，可以直接映射为枚举值.
+ */
+template<size_t N, size_t TableSize>
+class PerfectHashSet
+{
+    static_assert((TableSize & (TableSize - 1)) == 0, "TableSize must be a power of two");
+    static_assert(TableSize >= N, "TableSize must not be less than the number of words");
+    static_assert(N <= 256, "indexOf stores word indices in uint8_t");
+
+public:
+    consteval explicit PerfectHashSet(const std::array<std::string_view, N> &words)
+    {
+        for (const auto &w: words) {
+            mMinLength = std::min(mMinLength, w.size());
+            mMaxLength = std::max(mMaxLength, w.size());
+        }
+
+        for (uint32_t seed = 1; seed < 0x10000; seed++) {
+            std::array<std::string_view, TableSize> table{};
+            std::array<uint8_t, TableSize> index{};
+            bool collided = false;
+            for (size_t i = 0; i < N; i++) {
+                const size_t slot = hash(words[i], seed) & (TableSize - 1);
+                if (!table[slot].empty()) {
+                    collided = true;
+                    break;
+                }
+                table[slot] = words[i];
+                index[slot] = static_cast<uint8_t>(i);
+            }
+            if (!collided) {
+                mSeed = seed;
+                mTable = table;
+                mIndex = index;
+                return;
+            }
+        }
+        // 找不到种子时在编译期报错
+        throw "PerfectHashSet: no collision-free seed, increase TableSize";
+    }
+
+    constexpr bool contains(std::string_view str) const
+    {
+        return indexOf(str) >= 0;
+    }
+
+    constexpr int indexOf(std::string_view str) const
+    {
+        if (str.size() < mMinLength || str.size() > mMaxLength) {
+            return -1;
+        }
+        const size_t slot = hash(str, mSeed) & (TableSize - 1);
+        return mTable[slot] == str ? mIndex[slot] : -1;
+    }
+
+    static constexpr uint32_t hash(std::string_view str, uint32_t seed)
+    {
+        // FNV-1a 32，以种子作为初始值
+        uint32_t h = 2166136261u ^ seed;
+        for (const char c: str) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619u;
+        }
+        return h ^ (h >> 15);
+    }
+
+private:
+    std::array<std::string_view, TableSize> mTable{};
+    std::array<uint8_t, TableSize> mIndex{};
+    uint32_t mSeed = 0;
+    size_t mMinLength = SIZE_MAX;
+    size_t mMaxLength = 0;
+};
+
+#endif //PERFECT_HASH_SET_H
@@ -0,0 +1,154 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "run_stats.h"
+#include "alloc_counter.h"
+#include "json_string.h"
+
+#include <cstdio>
+#include <sstream>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+static std::string ms(uint64_t ns)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", static_cast<double>(ns) / 1e6);
+    return buf;
+}
+
+//=======================================================
+
+RunStats::RunStats()
+    : mBegin(std::chrono::steady_clock::now()),
+      mAllocationsBegin(AllocCounter::count())
+{
+}
+
+void RunStats::addFile(const FileStats &file)
+{
+    mFiles.push_back(file);
+}
+
+std::string RunStats::format(Format format, std::string_view version, std::string_view moduleName, size_t jobs) const
+{
+    const uint64_t wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mBegin).count();
+    const uint64_t allocations = AllocCounter::count() - mAllocationsBegin;
+    const uint64_t peakRss = peakRssBytes();
+
+    FileStats total;
+    size_t skipped = 0;
+    size_t written = 0;
+    for (const auto &f: mFiles) {
+        total.bytes += f.bytes;
+        total.commentBlocks += f.commentBlocks;
+        total.classes += f.classes;
+        total.enums += f.enums;
+        total.funcs += f.funcs;
+        total.overloads += f.overloads;
+        total.parseNs += f.parseNs;
+        total.generateNs += f.generateNs;
+        total.writeNs += f.writeNs;
+        skipped += f.skipped ? 1 : 0;
+        written += f.written ? 1 : 0;
+    }
+
+    std::stringstream os;
+    if (format == Format::Json) {
+        auto fileFields = [&](const FileStats &f) {
+            os << "\"bytes\": " << f.bytes
+                << ", \"commentBlocks\": " << f.commentBlocks
+                << ", \"classes\": " << f.classes
+                << ", \"enums\": " << f.enums
+                << ", \"functions\": " << f.funcs
+                << ", \"overloads\": " << f.overloads
+                << ", \"parseMs\": " << ms(f.parseNs)
+                << ", \"generateMs\": " << ms(f.generateNs)
+                << ", \"writeMs\": " << ms(f.writeNs);
+        };
+
+        os << "{\n"
+            << "  \"version\": " << jsonString(version) << ",\n"
+            << "  \"module\": " << jsonString(moduleName) << ",\n"
+            << "  \"jobs\": " << jobs << ",\n"
+            << "  \"wallTimeMs\": " << ms(wallNs) << ",\n"
+            << "  \"peakRssBytes\": " << peakRss << ",\n";
+        // 只有替换了全局 new/delete 的程序（autoany-bench）能统计分配次数
+        if (AllocCounter::enabled()) {
+            os << "  \"allocations\": " << allocations << ",\n";
+        }
+        os << "  \"files\": [";
+        for (size_t i = 0; i < mFiles.size(); i++) {
+            const auto &f = mFiles[i];
+            os << (i == 0 ? "\n" : ",\n")
+                << "    {\"source\": " << jsonString(f.source)
+                << ", \"skipped\": " << (f.skipped ? "true" : "false")
+                << ", \"written\": " << (f.written ? "true" : "false") << ", ";
+            fileFields(f);
+            os << "}";
+        }
+        os << (mFiles.empty() ? "],\n" : "\n  ],\n");
+        os << "  \"total\": {\"files\": " << mFiles.size()
+            << ", \"skipped\": " << skipped
+            << ", \"written\": " << written << ", ";
+        fileFields(total);
+        os << "}\n"
+            << "}\n";
+        return os.str();
+    }
+
+    char line[256];
+    snprintf(line, sizeof(line), "%-40s %10s %7s %7s %7s %9s %10s %10s %10s\n",
+             "source", "bytes", "blocks", "classes", "funcs", "overloads", "parse(ms)", "gen(ms)", "write(ms)");
+    os << line;
+    auto printRow = [&](std::string_view name, const FileStats &f) {
+        snprintf(line, sizeof(line), "%-40.*s %10llu %7u %7u %7u %9u %10s %10s %10s\n",
+                 static_cast<int>(name.size()), name.data(),
+                 static_cast<unsigned long long>(f.bytes), f.commentBlocks, f.classes, f.funcs, f.overloads,
+                 ms(f.parseNs).c_str(), ms(f.generateNs).c_str(), ms(f.writeNs).c_str());
+        os << line;
+    };
+    for (const auto &f: mFiles) {
+        printRow(f.skipped ? f.source + " (skipped)" : f.source, f);
+    }
+    printRow("total", total);
+    os << "files: " << mFiles.size() << ", skipped: " << skipped << ", written: " << written
+        << ", jobs: " << jobs << "\n"
+        << "wall time: " << ms(wallNs) << " ms, peak RSS: " << peakRss / 1024 << " KB";
+    if (AllocCounter::enabled()) {
+        os << ", allocations: " << allocations;
+    }
+    os << "\n";
+    return os.str();
+}
+
+uint64_t RunStats::peakRssBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
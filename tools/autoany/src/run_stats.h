@@ -0,0 +1,90 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * 单个输入头文件的处理统计，时间单位为纳秒.
+ */
+struct FileStats
+{
+    std::string source;
+    uint64_t bytes = 0;
+    uint32_t commentBlocks = 0;
+    uint32_t classes = 0;
+    uint32_t enums = 0;
+    uint32_t funcs = 0;
+    uint32_t overloads = 0;
+    bool skipped = false; // 增量构建时内容未变化而跳过
+    bool written = false; // 输出文件内容有变化并被重写
+    uint64_t parseNs = 0;
+    uint64_t generateNs = 0;
+    uint64_t writeNs = 0;
+};
+
+/**
+ * 把作用域内的耗时累加到指定计数上.
+ */
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(uint64_t &elapsedNs)
+        : mElapsedNs(elapsedNs),
+          mBegin(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedTimer()
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - mBegin;
+        mElapsedNs += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+private:
+    uint64_t &mElapsedNs;
+    std::chrono::steady_clock::time_point mBegin;
+};
+
+/**
+ * 一次运行的统计汇总，构造时开始计时，输出时附带总耗时、峰值内存和内存分配次数.
+ */
+class RunStats
+{
+public:
+    enum class Format
+    {
+        Text,
+        Json,
+    };
+
+    RunStats();
+
+    void addFile(const FileStats &file);
+
+    std::string format(Format format, std::string_view version, std::string_view moduleName, size_t jobs) const;
+
+    /**
+     * 进程的峰值常驻内存，单位字节，无法获取时返回 0.
+     */
+    static uint64_t peakRssBytes();
+
+private:
+    std::chrono::steady_clock::time_point mBegin;
+    uint64_t mAllocationsBegin = 0;
+    std::vector<FileStats> mFiles;
+};
+
+#endif //RUN_STATS_H
@@ -0,0 +1,85 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "shard_plan.h"
+
+#include <algorithm>
+#include <numeric>
+
+
+// 最重的分片超出平均负载这么多时才迁移，小幅波动不改变分配
+static constexpr double REBALANCE_TOLERANCE = 1.25;
+
+static uint32_t lightestShard(const std::vector<uint64_t> &loads)
+{
+    return static_cast<uint32_t>(std::min_element(loads.begin(), loads.end()) - loads.begin());
+}
+
+static uint32_t heaviestShard(const std::vector<uint64_t> &loads)
+{
+    return static_cast<uint32_t>(std::max_element(loads.begin(), loads.end()) - loads.begin());
+}
+
+std::vector<uint32_t> ShardPlan::assign(std::span<const Item> items, uint32_t shardCount)
+{
+    std::vector<uint32_t> shards(items.size(), NO_SHARD);
+    if (shardCount == 0) {
+        return shards;
+    }
+
+    std::vector<uint64_t> loads(shardCount, 0);
+    std::vector<size_t> newItems;
+    for (size_t i = 0; i < items.size(); i++) {
+        if (items[i].prevShard < shardCount) {
+            shards[i] = items[i].prevShard;
+            loads[shards[i]] += items[i].weight;
+        } else {
+            newItems.push_back(i);
+        }
+    }
+
+    // LPT：重的先放，相同权重按输入顺序，结果只取决于输入
+    std::stable_sort(newItems.begin(), newItems.end(), [&](size_t a, size_t b) {
+        return items[a].weight > items[b].weight;
+    });
+    for (const size_t i: newItems) {
+        const uint32_t shard = lightestShard(loads);
+        shards[i] = shard;
+        loads[shard] += items[i].weight;
+    }
+
+    const uint64_t total = std::accumulate(loads.begin(), loads.end(), uint64_t(0));
+    uint64_t maxWeight = 0;
+    for (const auto &item: items) {
+        maxWeight = std::max(maxWeight, item.weight);
+    }
+    const double limit = std::max(static_cast<double>(total) / shardCount, static_cast<double>(maxWeight)) * REBALANCE_TOLERANCE;
+
+    // 每次把最重分片中能让两边都低于原最大值的最重 item 移到最轻分片，直到回到容差内
+    for (size_t moves = 0; moves < items.size(); moves++) {
+        const uint32_t heavy = heaviestShard(loads);
+        const uint32_t light = lightestShard(loads);
+        if (static_cast<double>(loads[heavy]) <= limit || heavy == light) {
+            break;
+        }
+
+        size_t best = items.size();
+        for (size_t i = 0; i < items.size(); i++) {
+            if (shards[i] != heavy || items[i].weight == 0 || loads[light] + items[i].weight >= loads[heavy]) {
+                continue;
+            }
+            if (best == items.size() || items[i].weight > items[best].weight) {
+                best = i;
+            }
+        }
+        if (best == items.size()) {
+            break;
+        }
+        shards[best] = light;
+        loads[heavy] -= items[best].weight;
+        loads[light] += items[best].weight;
+    }
+
+    return shards;
+}
@@ -0,0 +1,37 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef SHARD_PLAN_H
+#define SHARD_PLAN_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+/**
+ * 把各个头文件的反射函数分配到固定数量的分片翻译单元中，按估算的模板实例化权重均衡.
+ * 上一次的分配会尽量保留，单个头文件的修改不会让其他头文件换到别的分片，避免所有分片重新编译.
+ */
+class ShardPlan
+{
+public:
+    static constexpr uint32_t NO_SHARD = UINT32_MAX;
+
+    struct Item
+    {
+        uint64_t weight = 0;
+        uint32_t prevShard = NO_SHARD; // 上一次所在的分片，新文件为 NO_SHARD
+    };
+
+public:
+    /**
+     * 返回每个 item 所在的分片下标.
+     * 已有分配的 item 保持不动，新 item 按权重从大到小放入当前最轻的分片；
+     * 只有最重的分片明显超出平均值时才迁移少量 item.
+     */
+    static std::vector<uint32_t> assign(std::span<const Item> items, uint32_t shardCount);
+};
+
+#endif //SHARD_PLAN_H
@@ -0,0 +1,392 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "source_lexer.h"
+
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static bool isIdentChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+//=======================================================
+
+SourceLexer::SourceLexer(std::string_view source)
+    : mSource(source)
+{
+}
+
+bool SourceLexer::next(SourceToken &token)
+{
+    if (mPendingScopeOpen) {
+        mPendingScopeOpen = false;
+        token = {SourceToken::Type::ScopeOpen, mPendingScopeOffset, 1};
+        return true;
+    }
+    if (mWantSignature) {
+        mWantSignature = false;
+        if (scanSignature(token)) {
+            return true;
+        }
+        if (mPendingScopeOpen) {
+            return next(token);
+        }
+    }
+
+    const size_t n = mSource.size();
+    while (mPos < n) {
+        const char c = mSource[mPos];
+        if (c == '\n') {
+            mLineStart = true;
+            ++mPos;
+            continue;
+        }
+        if (isSpace(c)) {
+            ++mPos;
+            continue;
+        }
+
+        const bool lineStart = mLineStart;
+        mLineStart = false;
+
+        if (c == '/' && mPos + 1 < n && mSource[mPos + 1] == '/') {
+            if (lineStart && mPos + 2 < n && mSource[mPos + 2] == '/') {
+                // 连续的 /// 行合并为一个注释块，空行或其他内容结束
+                const size_t begin = mPos;
+                size_t end = lineEnd(mPos);
+                while (end < n) {
+                    size_t p = end + 1;
+                    while (p < n && isSpace(mSource[p])) {
+                        ++p;
+                    }
+                    if (mSource.compare(p, 3, "///") != 0) {
+                        break;
+                    }
+                    end = lineEnd(p);
+                }
+                mPos = end;
+                token = {SourceToken::Type::CommentBlock, begin, end - begin};
+                mWantSignature = needsSignature(text(token));
+                return true;
+            }
+            mPos = lineEnd(mPos);
+            continue;
+        }
+
+        if (c == '/' && mPos + 1 < n && mSource[mPos + 1] == '*') {
+            const size_t begin = mPos;
+            mPos = skipBlockComment(mPos);
+            if (lineStart) {
+                token = {SourceToken::Type::CommentBlock, begin, mPos - begin};
+                mWantSignature = needsSignature(text(token));
+                return true;
+            }
+            continue;
+        }
+
+        if (c == '#' && lineStart) {
+            mPos = skipPreprocessor(mPos);
+            continue;
+        }
+
+        if (isLiteralStart(mPos)) {
+            mPos = skipLiteral(mPos);
+            continue;
+        }
+
+        if (c == '{') {
+            token = {SourceToken::Type::ScopeOpen, mPos, 1};
+            ++mPos;
+            return true;
+        }
+        if (c == '}') {
+            token = {SourceToken::Type::ScopeClose, mPos, 1};
+            ++mPos;
+            return true;
+        }
+
+        ++mPos;
+    }
+
+    return false;
+}
+
+bool SourceLexer::scanSignature(SourceToken &token)
+{
+    const size_t n = mSource.size();
+    size_t p = mPos;
+    bool lineStart = mLineStart;
+
+    // 跳过注释块与声明之间的空白、普通注释和预处理指令
+    while (p < n) {
+        const char c = mSource[p];
+        if (c == '\n') {
+            lineStart = true;
+            ++p;
+            continue;
+        }
+        if (isSpace(c)) {
+            ++p;
+            continue;
+        }
+        if (c == '/' && p + 1 < n && mSource[p + 1] == '/') {
+            if (lineStart && p + 2 < n && mSource[p + 2] == '/') {
+                break;
+            }
+            p = lineEnd(p);
+            continue;
+        }
+        if (c == '/' && p + 1 < n && mSource[p + 1] == '*') {
+            if (lineStart && p + 2 < n && mSource[p + 2] == '*') {
+                break;
+            }
+            p = skipBlockComment(p);
+            lineStart = false;
+            continue;
+        }
+        if (c == '#' && lineStart) {
+            p = skipPreprocessor(p);
+            continue;
+        }
+        break;
+    }
+
+    mPos = p;
+    mLineStart = lineStart;
+    if (p >= n || mSource[p] == '/') {
+        // 紧跟着下一个注释块，没有声明
+        return false;
+    }
+
+    const size_t begin = p;
+    size_t end = n;
+    int depth = 0;
+    lineStart = false;
+    while (p < n) {
+        const char c = mSource[p];
+        if (c == '\n') {
+            lineStart = true;
+            ++p;
+            continue;
+        }
+        if (isSpace(c)) {
+            ++p;
+            continue;
+        }
+
+        const bool atLineStart = lineStart;
+        lineStart = false;
+
+        if (c == '/' && p + 1 < n && mSource[p + 1] == '/') {
+            if (atLineStart && p + 2 < n && mSource[p + 2] == '/') {
+                end = p;
+                lineStart = true;
+                break;
+            }
+            p = lineEnd(p);
+            continue;
+        }
+        if (c == '/' && p + 1 < n && mSource[p + 1] == '*') {
+            if (atLineStart && p + 2 < n && mSource[p + 2] == '*') {
+                end = p;
+                lineStart = true;
+                break;
+            }
+            p = skipBlockComment(p);
+            continue;
+        }
+        if (isLiteralStart(p)) {
+            p = skipLiteral(p);
+            continue;
+        }
+
+        if (c == '(' || c == '[') {
+            ++depth;
+        } else if ((c == ')' || c == ']') && depth > 0) {
+            --depth;
+        } else if (depth == 0) {
+            if (c == ';') {
+                end = p++;
+                break;
+            }
+            if (c == '{') {
+                end = p++;
+                mPendingScopeOpen = true;
+                mPendingScopeOffset = end;
+                break;
+            }
+            if (c == '}') {
+                // 由外层作为作用域结束处理
+                end = p;
+                break;
+            }
+        }
+        ++p;
+    }
+
+    mPos = p;
+    mLineStart = lineStart;
+    token = {SourceToken::Type::Signature, begin, end - begin};
+    return end > begin;
+}
+
+size_t SourceLexer::lineEnd(size_t pos) const
+{
+    const size_t end = mSource.find('\n', pos);
+    return end == std::string_view::npos ? mSource.size() : end;
+}
+
+size_t SourceLexer::skipBlockComment(size_t pos) const
+{
+    const size_t end = mSource.find("*/", pos + 2);
+    return end == std::string_view::npos ? mSource.size() : end + 2;
+}
+
+size_t SourceLexer::skipPreprocessor(size_t pos) const
+{
+    // 支持 '\' 续行，返回指令最后一行的换行位置
+    size_t end = lineEnd(pos);
+    while (end < mSource.size()) {
+        size_t last = end;
+        while (last > pos && mSource[last - 1] == '\r') {
+            --last;
+        }
+        if (last == pos || mSource[last - 1] != '\\') {
+            break;
+        }
+        end = lineEnd(end + 1);
+    }
+    return end;
+}
+
+bool SourceLexer::isLiteralStart(size_t pos) const
+{
+    const char c = mSource[pos];
+    if (c == '"') {
+        return true;
+    }
+    if (c == '\'') {
+        // 数字分隔符 1'000'000
+        size_t start = pos;
+        while (start > 0 && (isIdentChar(mSource[start - 1]) || mSource[start - 1] == '\'' || mSource[start - 1] == '.')) {
+            --start;
+        }
+        return start == pos || !(mSource[start] >= '0' && mSource[start] <= '9');
+    }
+    if (c == 'R' && pos + 1 < mSource.size() && mSource[pos + 1] == '"') {
+        size_t start = pos;
+        while (start > 0 && isIdentChar(mSource[start - 1])) {
+            --start;
+        }
+        const std::string_view prefix = mSource.substr(start, pos - start);
+        return prefix.empty() || prefix == "u8" || prefix == "u" || prefix == "U" || prefix == "L";
+    }
+    return false;
+}
+
+size_t SourceLexer::skipLiteral(size_t pos) const
+{
+    const size_t n = mSource.size();
+    if (mSource[pos] == 'R') {
+        // R"delim( ... )delim"
+        const size_t open = mSource.find('(', pos + 2);
+        if (open != std::string_view::npos && open - (pos + 2) <= 16) {
+            std::string closing(")");
+            closing.append(mSource.substr(pos + 2, open - (pos + 2)));
+            closing.push_back('"');
+            const size_t end = mSource.find(closing, open + 1);
+            return end == std::string_view::npos ? n : end + closing.size();
+        }
+        return pos + 1;
+    }
+
+    const char quote = mSource[pos];
+    size_t p = pos + 1;
+    while (p < n) {
+        const char c = mSource[p];
+        if (c == '\\') {
+            p += 2;
+            continue;
+        }
+        if (c == quote) {
+            return p + 1;
+        }
+        if (c == '\n') {
+            // 未闭合的字面量到行尾为止
+            return p;
+        }
+        ++p;
+    }
+    return n;
+}
+
+bool SourceLexer::needsSignature(std::string_view commentBlock)
+{
+    for (size_t at = commentBlock.find('@'); at != std::string_view::npos; at = commentBlock.find('@', at + 1)) {
+        const std::string_view tag = commentBlock.substr(at + 1);
+        if (tag.starts_with("construct") || tag.starts_with("func") ||
+            tag.starts_with("static_func") || tag.starts_with("meta_func")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view SourceLexer::trim(std::string_view str)
+{
+    size_t first = 0;
+    while (first < str.size() && (isSpace(str[first]) || str[first] == '\n')) {
+        ++first;
+    }
+    size_t last = str.size();
+    while (last > first && (isSpace(str[last - 1]) || str[last - 1] == '\n')) {
+        --last;
+    }
+    return str.substr(first, last - first);
+}
+
+void SourceLexer::appendCodeText(std::string &out, std::string_view code)
+{
+    SourceLexer lexer(code);
+    const size_t n = code.size();
+    bool pendingSpace = false;
+    size_t p = 0;
+    while (p < n) {
+        const char c = code[p];
+        if (c == '\n' || isSpace(c)) {
+            pendingSpace = true;
+            ++p;
+            continue;
+        }
+        if (c == '/' && p + 1 < n && code[p + 1] == '/') {
+            p = lexer.lineEnd(p);
+            pendingSpace = true;
+            continue;
+        }
+        if (c == '/' && p + 1 < n && code[p + 1] == '*') {
+            p = lexer.skipBlockComment(p);
+            pendingSpace = true;
+            continue;
+        }
+
+        if (pendingSpace && !out.empty() && out.back() != ' ') {
+            out.push_back(' ');
+        }
+        pendingSpace = false;
+
+        if (lexer.isLiteralStart(p)) {
+            const size_t end = lexer.skipLiteral(p);
+            out.append(code.substr(p, end - p));
+            p = end;
+            continue;
+        }
+        out.push_back(c);
+        ++p;
+    }
+}
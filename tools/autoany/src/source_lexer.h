@@ -0,0 +1,119 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef SOURCE_LEXER_H
+#define SOURCE_LEXER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+struct SourceToken
+{
+    enum class Type : uint8_t
+    {
+        CommentBlock, // 行首的 /** */ 注释，或连续的 /// 注释行
+        Signature,    // 需要函数签名的注释块之后的声明，到 ';' 或 '{' 为止（不含）
+        ScopeOpen,
+        ScopeClose,
+    };
+
+    Type type = Type::CommentBlock;
+    size_t offset = 0;
+    size_t length = 0;
+};
+
+/**
+ * 单趟扫描源码缓冲区的状态机词法器，按顺序产出注释块、函数签名和作用域开闭标记.
+ * 字符串/字符字面量、原始字符串、普通注释和预处理指令中的括号不会被计为作用域.
+ */
+class SourceLexer
+{
+public:
+    explicit SourceLexer(std::string_view source);
+
+    bool next(SourceToken &token);
+
+    std::string_view text(const SourceToken &token) const
+    {
+        return mSource.substr(token.offset, token.length);
+    }
+
+    /**
+     * 去掉注释标记和行首的 '*'，对注释块的每一行（已去除首尾空白）调用 fn.
+     */
+    template<typename Fn>
+    static void forEachCommentLine(std::string_view commentBlock, Fn &&fn);
+
+    /**
+     * 去掉代码片段中的注释，合并连续空白后追加到 out.
+     */
+    static void appendCodeText(std::string &out, std::string_view code);
+
+    static std::string_view trim(std::string_view str);
+
+    /**
+     * pos 处是否开始一个字符串/字符字面量或原始字符串，数字分隔符中的 '\'' 不算.
+     */
+    bool isLiteralStart(size_t pos) const;
+
+    /**
+     * 返回 pos 处开始的字面量之后的位置，未闭合的字面量到行尾为止.
+     */
+    size_t skipLiteral(size_t pos) const;
+
+private:
+    bool scanSignature(SourceToken &token);
+
+    size_t lineEnd(size_t pos) const;
+
+    size_t skipBlockComment(size_t pos) const;
+
+    size_t skipPreprocessor(size_t pos) const;
+
+    static bool needsSignature(std::string_view commentBlock);
+
+private:
+    std::string_view mSource;
+    size_t mPos = 0;
+    bool mLineStart = true;
+    bool mWantSignature = false;
+    bool mPendingScopeOpen = false;
+    size_t mPendingScopeOffset = 0;
+};
+
+template<typename Fn>
+void SourceLexer::forEachCommentLine(std::string_view commentBlock, Fn &&fn)
+{
+    const bool isLineComment = commentBlock.starts_with("///");
+
+    std::string_view body = commentBlock;
+    if (!isLineComment) {
+        body.remove_prefix(2);
+        if (body.ends_with("*/")) {
+            body.remove_suffix(2);
+        }
+        if (!body.empty() && (body.front() == '*' || body.front() == '!')) {
+            body.remove_prefix(1);
+        }
+    }
+
+    while (!body.empty()) {
+        const size_t eol = body.find('\n');
+        std::string_view line = trim(body.substr(0, eol));
+        body.remove_prefix(eol == std::string_view::npos ? body.size() : eol + 1);
+
+        if (isLineComment) {
+            if (line.starts_with("///")) {
+                line = trim(line.substr(3));
+            }
+        } else if (line.starts_with('*')) {
+            line = trim(line.substr(1));
+        }
+        fn(line);
+    }
+}
+
+#endif //SOURCE_LEXER_H
@@ -0,0 +1,123 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "task_pool.h"
+#include "job_server.h"
+
+
+TaskPool::TaskPool(size_t threadCount, JobServer *jobServer)
+    : mJobServer(jobServer)
+{
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    mWorkers.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; i++) {
+        mWorkers.emplace_back(&TaskPool::workerLoop, this);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard lock(mMutex);
+        mStop = true;
+    }
+    mWakeCond.notify_all();
+    for (auto &t: mWorkers) {
+        t.join();
+    }
+}
+
+void TaskPool::run(size_t count, const std::function<void(size_t)> &task)
+{
+    if (count == 0) {
+        return;
+    }
+    if (mWorkers.empty() || count == 1) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(mMutex);
+        mTask = &task;
+        mCount = count;
+        mNext = 0;
+        mFinished = 0;
+        mGeneration++;
+    }
+    mWakeCond.notify_all();
+
+    drain();
+
+    std::unique_lock lock(mMutex);
+    mDoneCond.wait(lock, [this] { return mFinished == mCount; });
+    mTask = nullptr;
+}
+
+void TaskPool::workerLoop()
+{
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mMutex);
+            mWakeCond.wait(lock, [&] { return mStop || mGeneration != seenGeneration; });
+            if (mStop) {
+                return;
+            }
+            seenGeneration = mGeneration;
+        }
+        if (!mJobServer) {
+            drain();
+            continue;
+        }
+
+        // 等待令牌期间任务可能已被其他线程做完，每次等待后重新检查
+        constexpr int TOKEN_WAIT_MS = 20;
+        bool acquired = false;
+        while (!acquired && hasPendingTask()) {
+            acquired = mJobServer->acquire(TOKEN_WAIT_MS);
+        }
+        if (acquired) {
+            drain();
+            mJobServer->release();
+        }
+    }
+}
+
+bool TaskPool::hasPendingTask()
+{
+    std::lock_guard lock(mMutex);
+    return mTask && mNext < mCount;
+}
+
+void TaskPool::drain()
+{
+    while (true) {
+        size_t index;
+        const std::function<void(size_t)> *task;
+        {
+            std::lock_guard lock(mMutex);
+            if (!mTask || mNext >= mCount) {
+                return;
+            }
+            index = mNext++;
+            task = mTask;
+        }
+
+        (*task)(index);
+
+        bool allDone;
+        {
+            std::lock_guard lock(mMutex);
+            allDone = ++mFinished == mCount;
+        }
+        if (allDone) {
+            mDoneCond.notify_all();
+        }
+    }
+}
@@ -0,0 +1,67 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobServer;
+
+
+/**
+ * 固定线程数的工作池，用于并行处理互相独立的输入文件.
+ * run() 会阻塞到所有任务完成，调用线程本身也参与执行.
+ * 指定 jobServer 时调用线程使用进程的隐含令牌，其余线程每轮各取一个令牌才参与执行，
+ * 并行度不会超过 make 分配给整个构建的任务数.
+ */
+class TaskPool
+{
+public:
+    explicit TaskPool(size_t threadCount, JobServer *jobServer = nullptr);
+
+    ~TaskPool();
+
+    TaskPool(const TaskPool &) = delete;
+
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    size_t threadCount() const
+    {
+        return mWorkers.size() + 1;
+    }
+
+    /**
+     * 对 [0, count) 中每个下标调用一次 task，执行顺序不确定.
+     */
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+private:
+    void workerLoop();
+
+    void drain();
+
+    bool hasPendingTask();
+
+private:
+    std::vector<std::thread> mWorkers;
+    JobServer *mJobServer = nullptr;
+    std::mutex mMutex;
+    std::condition_variable mWakeCond;
+    std::condition_variable mDoneCond;
+
+    const std::function<void(size_t)> *mTask = nullptr;
+    size_t mCount = 0;
+    size_t mNext = 0;
+    size_t mFinished = 0;
+    uint64_t mGeneration = 0;
+    bool mStop = false;
+};
+
+#endif //TASK_POOL_H
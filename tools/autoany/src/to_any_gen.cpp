@@ -7,8 +7,699 @@
 #include "gx/gany.h"
 #include "gx/gstring.h"
 
+#include <algorithm>
 
-std::string formatString(const std::string &value)
+
+static constexpr std::string_view ENUM_HEADER_CODE = R"CODE(// Generated by autoany.
+
+#ifndef AUTOANY_ENUM_H
+#define AUTOANY_ENUM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace autoany
+{
+
+template<typename E>
+struct EnumItem
+{
+    E value;
+    const char *name;
+};
+
+/**
+ * 编译期按值排序的枚举项，取值连续时按偏移直接取名字，否则二分查找.
+ */
+template<typename E, size_t N>
+struct EnumIndex
+{
+    using Value = std::underlying_type_t<E>;
+
+    std::array<Value, N> values{};
+    std::array<const char *, N> names{};
+    size_t count = 0;
+    bool dense = false;
+
+    constexpr const char *name(E e) const
+    {
+        const auto v = static_cast<Value>(e);
+        if (count == 0 || v < values[0] || v > values[count - 1]) {
+            return "";
+        }
+        if (dense) {
+            using Unsigned = std::make_unsigned_t<Value>;
+            return names[static_cast<size_t>(static_cast<Unsigned>(static_cast<Unsigned>(v) - static_cast<Unsigned>(values[0])))];
+        }
+        size_t lo = 0;
+        size_t hi = count;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (values[mid] < v) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo < count && values[lo] == v ? names[lo] : "";
+    }
+};
+
+template<typename E, size_t N>
+constexpr EnumIndex<E, N> makeEnumIndex(const EnumItem<E> (&items)[N])
+{
+    using Value = std::underlying_type_t<E>;
+
+    // 自底向上的稳定归并排序，取值相同的别名保留最先声明的名字
+    std::array<size_t, N> order{};
+    std::array<size_t, N> buffer{};
+    for (size_t i = 0; i < N; i++) {
+        order[i] = i;
+    }
+    for (size_t width = 1; width < N; width *= 2) {
+        for (size_t lo = 0; lo < N; lo += 2 * width) {
+            const size_t mid = lo + width < N ? lo + width : N;
+            const size_t hi = lo + 2 * width < N ? lo + 2 * width : N;
+            size_t a = lo;
+            size_t b = mid;
+            for (size_t k = lo; k < hi; k++) {
+                if (a < mid && (b >= hi || static_cast<Value>(items[order[b]].value) >= static_cast<Value>(items[order[a]].value))) {
+                    buffer[k] = order[a++];
+                } else {
+                    buffer[k] = order[b++];
+                }
+            }
+        }
+        order = buffer;
+    }
+
+    EnumIndex<E, N> index;
+    for (size_t i = 0; i < N; i++) {
+        const EnumItem<E> &item = items[order[i]];
+        const auto v = static_cast<Value>(item.value);
+        if (index.count > 0 && index.values[index.count - 1] == v) {
+            continue;
+        }
+        index.values[index.count] = v;
+        index.names[index.count] = item.name;
+        index.count++;
+    }
+    // 在无符号类型中求跨度，INT_MIN 和 INT_MAX 这样的取值范围不会溢出
+    using Unsigned = std::make_unsigned_t<Value>;
+    if (index.count > 0) {
+        const auto span = static_cast<Unsigned>(static_cast<Unsigned>(index.values[index.count - 1]) - static_cast<Unsigned>(index.values[0]));
+        index.dense = static_cast<uint64_t>(span) == index.count - 1;
+    }
+    return index;
+}
+
+/**
+ * 编译期构建的名字到枚举值的完美哈希（hash and displace）.
+ * 每个名字先按哈希分桶，桶内共用一个位移，查找只需一次哈希和一次比较，不分配内存.
+ * 某个桶找不到不冲突的位移时（例如两个名字的 64 位哈希相同），整张表改为按名字排序、二分查找，构建总能成功.
+ */
+template<typename E, size_t N>
+struct EnumNameHash
+{
+    static constexpr size_t ceilPow2(size_t n)
+    {
+        size_t p = 1;
+        while (p < n) {
+            p *= 2;
+        }
+        return p;
+    }
+
+    // 装载率不超过 1/2，平均每个桶 4 个名字
+    static constexpr size_t TABLE_SIZE = ceilPow2(N * 2);
+    static constexpr size_t BUCKET_COUNT = ceilPow2((N + 3) / 4);
+    static constexpr uint32_t MAX_DISPLACE = 4096;
+
+    std::array<uint32_t, BUCKET_COUNT> displace{};
+    std::array<const char *, TABLE_SIZE> names{};
+    std::array<E, TABLE_SIZE> values{};
+    bool sorted = false; // 为 true 时前 N 项按名字排序，使用二分查找
+
+    static constexpr uint64_t hash(std::string_view str)
+    {
+        // FNV-1a 64
+        uint64_t h = 14695981039346656037ull;
+        for (const char c: str) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    static constexpr size_t bucketOf(uint64_t h)
+    {
+        return static_cast<size_t>((h * 0x9E3779B97F4A7C15ull) >> 40) & (BUCKET_COUNT - 1);
+    }
+
+    static constexpr size_t slotOf(uint64_t h, uint32_t d)
+    {
+        // 位移参与完整的 64 位混合，哈希不同的两个名字不会对所有位移都落到同一个槽
+        uint64_t x = h + (static_cast<uint64_t>(d) + 1) * 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        x ^= x >> 31;
+        return static_cast<size_t>(x) & (TABLE_SIZE - 1);
+    }
+
+    // 按 string_view 查找，不分配内存；找不到时返回 nullptr
+    constexpr const E *find(std::string_view name) const
+    {
+        if (sorted) {
+            size_t lo = 0;
+            size_t hi = N;
+            while (lo < hi) {
+                const size_t mid = lo + (hi - lo) / 2;
+                if (std::string_view(names[mid]) < name) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo < N && name == names[lo] ? &values[lo] : nullptr;
+        }
+        const uint64_t h = hash(name);
+        const size_t slot = slotOf(h, displace[bucketOf(h)]);
+        if (names[slot] != nullptr && name == names[slot]) {
+            return &values[slot];
+        }
+        return nullptr;
+    }
+};
+
+template<typename E, size_t N>
+constexpr EnumNameHash<E, N> makeSortedEnumNames(const EnumItem<E> (&items)[N])
+{
+    // 自底向上的归并排序
+    std::array<size_t, N> order{};
+    std::array<size_t, N> buffer{};
+    for (size_t i = 0; i < N; i++) {
+        order[i] = i;
+    }
+    for (size_t width = 1; width < N; width *= 2) {
+        for (size_t lo = 0; lo < N; lo += 2 * width) {
+            const size_t mid = lo + width < N ? lo + width : N;
+            const size_t hi = lo + 2 * width < N ? lo + 2 * width : N;
+            size_t a = lo;
+            size_t b = mid;
+            for (size_t k = lo; k < hi; k++) {
+                if (a < mid && (b >= hi || std::string_view(items[order[b]].name) >= std::string_view(items[order[a]].name))) {
+                    buffer[k] = order[a++];
+                } else {
+                    buffer[k] = order[b++];
+                }
+            }
+        }
+        order = buffer;
+    }
+
+    EnumNameHash<E, N> table;
+    table.sorted = true;
+    for (size_t i = 0; i < N; i++) {
+        table.names[i] = items[order[i]].name;
+        table.values[i] = items[order[i]].value;
+    }
+    return table;
+}
+
+template<typename E, size_t N>
+constexpr EnumNameHash<E, N> makeEnumNameHash(const EnumItem<E> (&items)[N])
+{
+    using Hash = EnumNameHash<E, N>;
+    constexpr size_t BUCKET_COUNT = Hash::BUCKET_COUNT;
+
+    // 按桶计数排序，得到每个桶的名字列表
+    std::array<uint64_t, N> hashes{};
+    std::array<size_t, BUCKET_COUNT + 1> bucketStart{};
+    for (size_t i = 0; i < N; i++) {
+        hashes[i] = Hash::hash(items[i].name);
+        bucketStart[Hash::bucketOf(hashes[i]) + 1]++;
+    }
+    size_t maxBucketSize = 0;
+    for (size_t b = 0; b < BUCKET_COUNT; b++) {
+        maxBucketSize = bucketStart[b + 1] > maxBucketSize ? bucketStart[b + 1] : maxBucketSize;
+        bucketStart[b + 1] += bucketStart[b];
+    }
+    std::array<size_t, N> members{};
+    std::array<size_t, BUCKET_COUNT> fill{};
+    for (size_t i = 0; i < N; i++) {
+        const size_t b = Hash::bucketOf(hashes[i]);
+        members[bucketStart[b] + fill[b]++] = i;
+    }
+
+    // 大桶先放，空位多时更容易找到不冲突的位移
+    Hash table;
+    std::array<bool, Hash::TABLE_SIZE> used{};
+    for (size_t size = maxBucketSize; size > 0; size--) {
+        for (size_t b = 0; b < BUCKET_COUNT; b++) {
+            if (bucketStart[b + 1] - bucketStart[b] != size) {
+                continue;
+            }
+            bool found = false;
+            for (uint32_t d = 0; d < Hash::MAX_DISPLACE; d++) {
+                size_t placed = 0;
+                for (; placed < size; placed++) {
+                    const size_t slot = Hash::slotOf(hashes[members[bucketStart[b] + placed]], d);
+                    if (used[slot]) {
+                        break;
+                    }
+                    used[slot] = true;
+                }
+                if (placed == size) {
+                    table.displace[b] = d;
+                    found = true;
+                    break;
+                }
+                for (size_t k = 0; k < placed; k++) {
+                    used[Hash::slotOf(hashes[members[bucketStart[b] + k]], d)] = false;
+                }
+            }
+            if (!found) {
+                return makeSortedEnumNames(items);
+            }
+            for (size_t k = bucketStart[b]; k < bucketStart[b + 1]; k++) {
+                const size_t slot = Hash::slotOf(hashes[members[k]], table.displace[b]);
+                table.names[slot] = items[members[k]].name;
+                table.values[slot] = items[members[k]].value;
+            }
+        }
+    }
+    return table;
+}
+
+template<typename R, typename C, typename A>
+A defEnumParamOf(R (C::*)(A));
+
+template<typename R, typename C, typename A>
+A defEnumParamOf(R (C::*)(A) noexcept);
+
+template<typename Builder, typename V, typename = void>
+struct DefEnumTemplateParam
+{
+    using type = void;
+};
+
+template<typename Builder, typename V>
+struct DefEnumTemplateParam<Builder, V, std::void_t<decltype(defEnumParamOf(&Builder::template defEnum<V>))> >
+{
+    using type = std::decay_t<decltype(defEnumParamOf(&Builder::template defEnum<V>))>;
+};
+
+/**
+ * 构建器 defEnum 声明的参数类型（去掉 const 和引用），defEnum 是以值类型为参数的模板时取 defEnum<V>；
+ * 有多个重载等无法取得的情况为 void.
+ */
+template<typename Builder, typename V, typename = void>
+struct DefEnumParam : DefEnumTemplateParam<Builder, V>
+{
+};
+
+template<typename Builder, typename V>
+struct DefEnumParam<Builder, V, std::void_t<decltype(defEnumParamOf(&Builder::defEnum))> >
+{
+    using type = std::decay_t<decltype(defEnumParamOf(&Builder::defEnum))>;
+};
+
+template<typename T>
+struct IsInitializerList : std::false_type
+{
+};
+
+template<typename T>
+struct IsInitializerList<std::initializer_list<T> > : std::true_type
+{
+};
+
+template<typename C, typename = void>
+struct HasReserve : std::false_type
+{
+};
+
+template<typename C>
+struct HasReserve<C, std::void_t<decltype(std::declval<C &>().reserve(size_t()))> > : std::true_type
+{
+};
+
+template<typename V, typename Builder, typename E, size_t N, size_t... I>
+void defEnumItems(Builder &builder, const EnumItem<E> (&items)[N], std::index_sequence<I...>)
+{
+    builder.defEnum({{items[I].name, static_cast<V>(items[I].value)}...});
+}
+
+/**
+ * 把表中的枚举项注册到类构建器上并返回构建器，链式调用可以继续.
+ * 所有枚举项在一次 defEnum 调用中传入，与直接写出的 .defEnum({...}) 相同.
+ * 容器使用 defEnum 声明的参数类型（元素类型可能是 GAny 等），在循环中从表里填入，不展开参数包；
+ * 参数类型无法取得或是 initializer_list 时，退回与直接写出的代码相同的花括号列表.
+ * V 是注册值的类型（@cast_to 指定的类型或枚举本身）.
+ */
+template<typename V, typename Builder, typename E, size_t N>
+Builder &defEnumTable(Builder &&builder, const EnumItem<E> (&items)[N])
+{
+    using Items = typename DefEnumParam<std::remove_reference_t<Builder>, V>::type;
+    if constexpr (std::is_void_v<Items> || IsInitializerList<Items>::value) {
+        defEnumItems<V>(builder, items, std::make_index_sequence<N>());
+    } else {
+        Items enumItems;
+        if constexpr (HasReserve<Items>::value) {
+            enumItems.reserve(N);
+        }
+        for (const auto &item: items) {
+            enumItems.insert(enumItems.end(), typename Items::value_type(item.name, static_cast<V>(item.value)));
+        }
+        builder.defEnum(enumItems);
+    }
+    return builder;
+}
+}
+
+#endif // AUTOANY_ENUM_H
+)CODE";
+
+static constexpr std::string_view LAZY_HEADER_CODE = R"CODE(// Generated by autoany.
+
+#ifndef AUTOANY_LAZY_H
+#define AUTOANY_LAZY_H
+
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace autoany
+{
+
+/**
+ * 延迟注册表，模块加载时只登记 "命名空间.类名" 和类型到注册函数的映射，
+ * 类的完整构建链在第一次 require 时执行，同一个注册函数只执行一次.
+ */
+class LazyClassTable
+{
+public:
+    using Thunk = void (*)();
+
+    static LazyClassTable &instance()
+    {
+        static LazyClassTable table;
+        return table;
+    }
+
+    /**
+     * 环境变量 AUTOANY_EAGER_REGISTRATION 非空且不为 0 时，模块加载后立即完成全部注册，
+     * 供需要遍历类数据库的工具（如 doc_make）使用.
+     */
+    static bool eagerRequested()
+    {
+        const char *value = std::getenv("AUTOANY_EAGER_REGISTRATION");
+        return value != nullptr && *value != '\0' && std::string_view(value) != "0";
+    }
+
+    void add(std::string_view ns, std::string_view name, Thunk thunk)
+    {
+        std::lock_guard lock(mMutex);
+        std::string fullName(ns);
+        if (!fullName.empty()) {
+            fullName.push_back('.');
+        }
+        fullName.append(name);
+        if (mByName.emplace(std::move(fullName), thunk).second) {
+            mThunks.push_back(thunk);
+        }
+    }
+
+    template<typename T>
+    void add(std::string_view ns, std::string_view name, Thunk thunk)
+    {
+        add(ns, name, thunk);
+        std::lock_guard lock(mMutex);
+        mByType.emplace(std::type_index(typeid(T)), thunk);
+    }
+
+    /**
+     * 按 "命名空间.类名" 完成注册，没有登记的名字返回 false.
+     */
+    bool require(std::string_view fullName)
+    {
+        Thunk thunk = nullptr;
+        {
+            std::lock_guard lock(mMutex);
+            const auto it = mByName.find(std::string(fullName));
+            if (it == mByName.end()) {
+                return false;
+            }
+            thunk = it->second;
+        }
+        run(thunk);
+        return true;
+    }
+
+    template<typename T>
+    bool require()
+    {
+        Thunk thunk = nullptr;
+        {
+            std::lock_guard lock(mMutex);
+            const auto it = mByType.find(std::type_index(typeid(T)));
+            if (it == mByType.end()) {
+                return false;
+            }
+            thunk = it->second;
+        }
+        run(thunk);
+        return true;
+    }
+
+    void requireAll()
+    {
+        std::vector<Thunk> thunks;
+        {
+            std::lock_guard lock(mMutex);
+            thunks = mThunks;
+        }
+        for (const Thunk thunk: thunks) {
+            run(thunk);
+        }
+    }
+
+    size_t size() const
+    {
+        std::lock_guard lock(mMutex);
+        return mByName.size();
+    }
+
+private:
+    void run(Thunk thunk)
+    {
+        // 注册函数会先 require 父类，递归锁允许同一线程重入；先标记再执行，其他线程等到注册完成
+        std::lock_guard lock(mRunMutex);
+        if (!mDone.insert(thunk).second) {
+            return;
+        }
+        thunk();
+    }
+
+private:
+    mutable std::mutex mMutex;
+    std::unordered_map<std::string, Thunk> mByName;
+    std::unordered_map<std::type_index, Thunk> mByType;
+    std::vector<Thunk> mThunks; // 按登记顺序，requireAll 的顺序与立即注册一致
+
+    std::recursive_mutex mRunMutex;
+    std::unordered_set<Thunk> mDone;
+};
+
+}
+
+#endif // AUTOANY_LAZY_H
+)CODE";
+
+static constexpr std::string_view TABLE_HEADER_CODE = R"CODE(// Generated by autoany.
+
+#ifndef AUTOANY_TABLE_H
+#define AUTOANY_TABLE_H
+
+#include <gx/gany.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace autoany
+{
+
+using namespace gany;
+
+/**
+ * 统一签名的调用函数，参数从 GAny 转换，非静态函数的 args[0] 是对象本身.
+ */
+using CallThunk = GAny (*)(const GAny **args, int32_t argc);
+
+struct MethodDesc
+{
+    const char *name;
+    const char *doc;
+    const char *const *args;
+    uint32_t argCount;
+    bool isStatic;
+    CallThunk call;
+};
+
+struct PropertyDesc
+{
+    const char *name;
+    const char *doc;
+    CallThunk getter; // 为空表示只写
+    CallThunk setter; // 为空表示只读
+};
+
+/**
+ * 按描述表注册函数并返回构建器，链式调用可以继续.
+ * 每个描述只实例化统一签名的可变参数函数，不再为每个成员函数实例化绑定模板.
+ */
+template<typename Builder, size_t N>
+Builder &defMethods(Builder &&builder, const MethodDesc (&methods)[N])
+{
+    for (const auto &m: methods) {
+        GAny func = GAnyFunction::createVariadicFunction(m.name, m.doc, m.call);
+        if (m.isStatic) {
+            builder.staticFunc(m.name, func, {.doc = m.doc, .args = std::vector<std::string>(m.args, m.args + m.argCount)});
+        } else {
+            builder.func(m.name, func, {.doc = m.doc, .args = std::vector<std::string>(m.args, m.args + m.argCount)});
+        }
+    }
+    return builder;
+}
+
+template<typename Builder, size_t N>
+Builder &defProperties(Builder &&builder, const PropertyDesc (&properties)[N])
+{
+    for (const auto &p: properties) {
+        builder.property(p.name,
+                         p.getter ? GAnyFunction::createVariadicFunction(p.name, p.doc, p.getter) : GAny(),
+                         p.setter ? GAnyFunction::createVariadicFunction(p.name, p.doc, p.setter) : GAny(),
+                         p.doc);
+    }
+    return builder;
+}
+
+}
+
+#endif // AUTOANY_TABLE_H
+)CODE";
+
+static constexpr std::string_view PROFILE_HEADER_CODE = R"CODE(// Generated by autoany.
+
+#ifndef AUTOANY_PROFILE_H
+#define AUTOANY_PROFILE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(_WIN32)
+#define AUTOANY_PROFILE_EXPORT __declspec(dllexport)
+#else
+#define AUTOANY_PROFILE_EXPORT __attribute__((visibility("default")))
+#endif
+
+/**
+ * 一次注册的耗时，C 布局，加载模块的工具通过 autoany_registration_profile_<Module> 读取.
+ * name 为空表示整个头文件的 ref 函数，耗时包含其中立即注册的类；延迟注册的类在第一次 require 时计时.
+ */
+struct AutoanyRegistrationSample
+{
+    const char *module;
+    const char *header;
+    const char *name;
+    uint64_t nanos;
+};
+
+namespace autoany
+{
+
+class RegistrationProfile
+{
+public:
+    static RegistrationProfile &instance()
+    {
+        static RegistrationProfile profile;
+        return profile;
+    }
+
+    void add(const AutoanyRegistrationSample &sample)
+    {
+        std::lock_guard lock(mMutex);
+        mSamples.push_back(sample);
+    }
+
+    /**
+     * 指定模块的样本，注册表在多个模块间共享时也只返回本模块的样本.
+     */
+    std::vector<AutoanyRegistrationSample> samples(const char *module) const
+    {
+        std::lock_guard lock(mMutex);
+        std::vector<AutoanyRegistrationSample> result;
+        for (const auto &sample: mSamples) {
+            if (std::strcmp(sample.module, module) == 0) {
+                result.push_back(sample);
+            }
+        }
+        return result;
+    }
+
+private:
+    mutable std::mutex mMutex;
+    std::vector<AutoanyRegistrationSample> mSamples;
+};
+
+class ScopedRegistrationTimer
+{
+public:
+    ScopedRegistrationTimer(const char *module, const char *header, const char *name)
+        : mSample{module, header, name, 0}, mStart(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~ScopedRegistrationTimer()
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - mStart;
+        mSample.nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        RegistrationProfile::instance().add(mSample);
+    }
+
+    ScopedRegistrationTimer(const ScopedRegistrationTimer &) = delete;
+
+    ScopedRegistrationTimer &operator=(const ScopedRegistrationTimer &) = delete;
+
+private:
+    AutoanyRegistrationSample mSample;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+}
+
+#endif // AUTOANY_PROFILE_H
+)CODE";
+
+std::string ToAnyGen::formatString(std::string_view value)
 {
     std::string out;
     out.reserve(value.size() * 2);
@@ -47,19 +738,200 @@ std::string formatString(const std::string &value)
     return out;
 }
 
-std::string ToAnyGen::genReflecClassCode(const ClassInfo &classInfo)
+static std::string classCppName(const ClassInfo &classInfo)
+{
+    if (classInfo.outerClass.empty()) {
+        return std::string(classInfo.cppName);
+    }
+    return std::string(classInfo.outerCppName) + "::" + std::string(classInfo.cppName);
+}
+
+static std::string classRefName(const ClassInfo &classInfo)
+{
+    return GString(std::string(classInfo.outerClass) + std::string(classInfo.name)).replace(".", "").toStdString();
+}
+
+static void appendIndented(std::stringstream &os, std::string_view code, std::string_view indent)
+{
+    size_t begin = 0;
+    while (begin < code.size()) {
+        size_t end = code.find('\n', begin);
+        if (end == std::string_view::npos) {
+            end = code.size();
+        }
+        if (end > begin) {
+            os << indent << code.substr(begin, end - begin);
+        }
+        os << "\n";
+        begin = end + 1;
+    }
+}
+
+static std::string classTableName(std::string_view refClassName, std::string_view table)
+{
+    return "s" + std::string(refClassName) + std::string(table);
+}
+
+static std::string enumItemsName(std::string_view enumRefName)
+{
+    return "s" + std::string(enumRefName) + "Items";
+}
+
+static std::string enumIndexName(std::string_view enumRefName)
+{
+    return "s" + std::string(enumRefName) + "Index";
+}
+
+static std::string enumNamesName(std::string_view enumRefName)
+{
+    return "s" + std::string(enumRefName) + "Names";
+}
+
+/**
+ * 完整声明的签名可以直接取成员函数指针；默认参数截断出的重载没有对应的函数类型，只能用 lambda 转发.
+ * 以 @func 绑定的 static 成员函数取地址得到普通函数指针，没有 self 参数，同样用 lambda 转发.
+ */
+static bool canCastOverload(const FuncInfo &func, const FuncSigInfo &sig, const OverloadInfo &overload, std::span<const ArgInfo> args)
+{
+    if (overload.argCount != sig.args.count || sig.retType.empty() || sig.retType.find("auto") != std::string_view::npos) {
+        return false;
+    }
+    if (sig.isStaticMember && !func.isStatic) {
+        return false;
+    }
+    return std::none_of(args.begin(), args.end(), [](const ArgInfo &arg) {
+        return arg.type.empty() || arg.type.find("...") != std::string_view::npos;
+    });
+}
+
+/**
+ * 非 const 左值引用参数无法从 GAny 转换出的临时值绑定，这类函数保持逐个重载绑定.
+ */
+static bool isMutableLvalueRef(std::string_view type)
+{
+    return type.ends_with('&') && !type.ends_with("&&") && type.find("const") == std::string_view::npos;
+}
+
+/**
+ * 参数按值从 GAny 转换，去掉声明类型的 const 和引用.
+ */
+static std::string_view argValueType(std::string_view type)
+{
+    while (!type.empty() && (type.back() == '&' || type.back() == ' ')) {
+        type.remove_suffix(1);
+    }
+    if (type.starts_with("const ")) {
+        type.remove_prefix(6);
+    }
+    if (type.ends_with(" const")) {
+        type.remove_suffix(6);
+    }
+    return type;
+}
+
+/**
+ * 统一签名的调用函数取出 args[0] 中的对象；参数少于 minArgc 或对象类型不符时抛出 GAnyException，与普通绑定的行为一致.
+ */
+static void genThunkSelf(std::stringstream &os, std::string_view cppClassName, std::string_view funcName, uint32_t minArgc)
+{
+    os << "        if (argc < " << minArgc << ") {\n"
+        << "            throw GAnyException(" << ToAnyGen::formatString(std::string(funcName) + (minArgc == 1 ? ": missing the object argument" : ": missing the object or value argument")) << ");\n"
+        << "        }\n"
+        << "        auto *object = args[0]->as<" << cppClassName << ">();\n"
+        << "        if (!object) {\n"
+        << "            throw GAnyException(" << ToAnyGen::formatString(std::string(funcName) + ": the object is not a " + std::string(cppClassName)) << ");\n"
+        << "        }\n"
+        << "        auto &self = *object;\n";
+}
+
+/**
+ * 所有重载都由同一个声明的签名按默认参数展开时，才能合并为一个按参数个数分派的绑定；
+ * 同名的其他签名仍需要运行时重载决议.
+ */
+static bool canDispatchByArity(const TypesInfo &typesInfo, const FuncInfo &func)
+{
+    if (func.overloads.size() < 2 || func.isMetaFunc) {
+        return false;
+    }
+    const ModelIndex sig = func.overloads.front().sig;
+    for (const auto &overload: func.overloads) {
+        if (overload.sig != sig) {
+            return false;
+        }
+    }
+    const auto args = typesInfo.overloadArgs(func.overloads.back());
+    return std::none_of(args.begin(), args.end(), [](const ArgInfo &arg) {
+        return arg.type.empty() || arg.type.find("...") != std::string_view::npos || isMutableLvalueRef(arg.type);
+    });
+}
+
+/**
+ * 描述表中的函数用统一签名的调用函数按参数个数分派，同名重载的参数个数必须互不相同.
+ */
+static bool canBindByTable(const TypesInfo &typesInfo, const FuncInfo &func)
+{
+    if (func.overloads.empty() || func.isMetaFunc) {
+        return false;
+    }
+    for (size_t i = 0; i < func.overloads.size(); i++) {
+        const OverloadInfo &overload = func.overloads[i];
+        for (size_t j = 0; j < i; j++) {
+            if (func.overloads[j].argCount == overload.argCount) {
+                return false;
+            }
+        }
+        if (typesInfo.signatures[overload.sig].retType.empty()) {
+            return false;
+        }
+        const auto args = typesInfo.overloadArgs(overload);
+        if (std::any_of(args.begin(), args.end(), [](const ArgInfo &arg) {
+            return arg.type.empty() || arg.type.find("...") != std::string_view::npos || isMutableLvalueRef(arg.type);
+        })) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 通过成员函数读写的属性可以生成描述表，setter 需要声明的签名确定参数类型.
+ */
+static bool canBindPropertyByTable(const TypesInfo &typesInfo, const PropertyInfo &p)
+{
+    if (p.packAgain || (p.getter == NO_INDEX && p.setter == NO_INDEX)) {
+        return false;
+    }
+    if (p.getter != NO_INDEX && typesInfo.funcs[p.getter].isStatic) {
+        return false;
+    }
+    if (p.setter != NO_INDEX) {
+        const FuncInfo &setter = typesInfo.funcs[p.setter];
+        if (setter.isStatic || setter.overloads.empty() || setter.overloads.front().argCount != 1) {
+            return false;
+        }
+        const std::string_view type = typesInfo.overloadArgs(setter.overloads.front())[0].type;
+        if (type.empty() || isMutableLvalueRef(type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string ToAnyGen::genReflecClassCode(const TypesInfo &typesInfo, const ClassInfo &classInfo, const Options &options)
 {
     std::stringstream code;
+    std::stringstream tables;
+
+    // 描述表模式下生成的函数和属性描述
+    std::vector<std::string_view> argNames;
+    std::stringstream methodDescs;
+    std::stringstream propertyDescs;
 
     std::vector<EnumClassInfo> interEnumInfos;
+    ParseArena interEnumNames;
 
-    std::string cppClassName = classInfo.cppName;
-    std::string refClassName = classInfo.name;
-    if (!classInfo.outerClass.empty()) {
-        cppClassName = classInfo.outerCppName + "::" + cppClassName;
-        refClassName = classInfo.outerClass + classInfo.name;
-    }
-    refClassName = GString(refClassName).replace(".", "").toStdString();
+    const std::string cppClassName = classCppName(classInfo);
+    const std::string refClassName = classRefName(classInfo);
 
     // Begin
     code << "Class<" << cppClassName << ">"
@@ -71,151 +943,355 @@ std::string ToAnyGen::genReflecClassCode(const ClassInfo &classInfo)
     }
 
     // construct
-    for (const auto &construct: classInfo.constructs) {
-        for (size_t oi = 0; oi < construct->overloads.size(); oi++) {
-            const auto overload = construct->overloads[oi];
+    for (const ModelIndex constructIndex: classInfo.constructs) {
+        const FuncInfo &construct = typesInfo.funcs[constructIndex];
+        for (const auto &overload: construct.overloads) {
+            const auto args = typesInfo.overloadArgs(overload);
             code << "\n    .construct<";
-            size_t argc = overload.argTypes.size();
-            for (size_t i = 0; i < argc; i++) {
+            for (size_t i = 0; i < args.size(); i++) {
                 if (i != 0)
                     code << ", ";
-                code << overload.argTypes[i];
+                code << args[i].type;
             }
             code << ">(";
-            genFuncDoc(code, *construct, oi);
+            genFuncDoc(code, construct, args);
             code << ")";
         }
     }
 
     // enum
-    for (const auto &e: classInfo.enums) {
-        std::string castTo = e->castTo;
-        code << "\n    .defEnum({\n";
-        for (const auto &ei: e->enumItems) {
-            code << "        {" << formatString(ei) << ", ";
-            if (!castTo.empty()) {
-                code << "static_cast<" << castTo << ">(";
-            }
-            code << cppClassName << "::" << e->cppName << "::" << ei;
-            if (!castTo.empty()) {
-                code << ")";
-            }
-            code << "},\n";
+    for (const ModelIndex enumIndex: classInfo.enums) {
+        const EnumInfo &e = typesInfo.enums[enumIndex];
+        const std::string enumRefName = refClassName + std::string(e.name);
+        const std::string enumCppName = cppClassName + "::" + std::string(e.cppName);
+        const auto items = typesInfo.items(e.enumItems);
+        if (!items.empty()) {
+            genEnumTable(tables, enumCppName, enumRefName, items);
+
+            // 枚举项在构建链的当前位置注册，把已经生成的部分包进注册函数，链式调用继续
+            const std::string head = code.str();
+            code.str({});
+            code << "autoany::defEnumTable<" << (e.castTo.empty() ? std::string_view(enumCppName) : e.castTo) << ">("
+                << head << ", " << enumItemsName(enumRefName) << ")";
         }
-        code << "    })";
 
         EnumClassInfo enumInfo{};
-        enumInfo.name = refClassName + e->name;
-        enumInfo.cppName = cppClassName + "::" + e->cppName;
+        enumInfo.name = interEnumNames.intern(refClassName + std::string(e.name));
+        enumInfo.cppName = interEnumNames.intern(cppClassName + "::" + std::string(e.cppName));
         enumInfo.ns = classInfo.ns;
-        enumInfo.castTo = e->castTo;
-        enumInfo.enumItems = e->enumItems;
-        enumInfo.doc = e->doc;
+        enumInfo.castTo = e.castTo;
+        enumInfo.enumItems = e.enumItems;
+        enumInfo.doc = e.doc;
         interEnumInfos.push_back(enumInfo);
     }
 
     // constant
-    for (const auto constant: classInfo.constants) {
-        code << "\n    .constant(" << formatString(constant->name) << ", " << cppClassName << "::" << constant->name << ")";
+    for (const auto &constant: classInfo.constants) {
+        code << "\n    .constant(" << formatString(constant.name) << ", " << cppClassName << "::" << constant.name << ")";
     }
 
     // property
-    for (const auto &p: classInfo.properties) {
-        if (p->hasGetter || p->hasSetter) {
-            code << "\n    .property(" << formatString(p->name) << ", ";
-            if (p->hasGetter) {
-                code << "&" << cppClassName << "::" << p->getter->name;
+    for (const ModelIndex propertyIndex: classInfo.properties) {
+        const PropertyInfo &p = typesInfo.properties[propertyIndex];
+        if (options.registrationTables && canBindPropertyByTable(typesInfo, p)) {
+            propertyDescs << "    {" << formatString(p.name) << ", " << formatString(p.doc) << ", ";
+            if (p.getter != NO_INDEX) {
+                propertyDescs << "[](const GAny **args, int32_t argc) -> GAny {\n";
+                genThunkSelf(propertyDescs, cppClassName, p.name, 1);
+                propertyDescs << "        return self." << typesInfo.funcs[p.getter].name << "();\n"
+                    << "    }";
+            } else {
+                propertyDescs << "nullptr";
+            }
+            propertyDescs << ", ";
+            if (p.setter != NO_INDEX) {
+                const FuncInfo &setter = typesInfo.funcs[p.setter];
+                const std::string_view type = typesInfo.overloadArgs(setter.overloads.front())[0].type;
+                propertyDescs << "[](const GAny **args, int32_t argc) -> GAny {\n";
+                genThunkSelf(propertyDescs, cppClassName, p.name, 2);
+                propertyDescs << "        self." << setter.name << "(args[1]->castAs<" << argValueType(type) << ">());\n"
+                    << "        return GAny();\n"
+                    << "    }";
+            } else {
+                propertyDescs << "nullptr";
+            }
+            propertyDescs << "},\n";
+        } else if (p.getter != NO_INDEX || p.setter != NO_INDEX) {
+            code << "\n    .property(" << formatString(p.name) << ", ";
+            if (p.getter != NO_INDEX) {
+                code << "&" << cppClassName << "::" << typesInfo.funcs[p.getter].name;
             } else {
                 code << "GAny()";
             }
             code << ", ";
-            if (p->hasSetter) {
-                code << "&" << cppClassName << "::" << p->setter->name;
+            if (p.setter != NO_INDEX) {
+                code << "&" << cppClassName << "::" << typesInfo.funcs[p.setter].name;
             } else {
                 code << "GAny()";
             }
-            code << ", " << formatString(p->doc);
+            code << ", " << formatString(p.doc);
             code << ")";
-        } else if (p->packAgain) {
-            code <<"\n    REF_PROPERTY_RW(" << cppClassName << ", " << p->type << ", " << p->name << ", " << formatString(p->doc) << ")";
+        } else if (p.packAgain) {
+            code <<"\n    REF_PROPERTY_RW(" << cppClassName << ", " << p.type << ", " << p.name << ", " << formatString(p.doc) << ")";
         } else {
-            code << "\n    .readWrite(" << formatString(p->name) << ", &" << cppClassName << "::" << p->name
-                << ", " << formatString(p->doc)
+            code << "\n    .readWrite(" << formatString(p.name) << ", &" << cppClassName << "::" << p.name
+                << ", " << formatString(p.doc)
                 << ")";
         }
     }
 
     // func && staticFunc
-    for (const auto &func: classInfo.funcs) {
-        bool hasOverloads = func->overloads.size() > 1;
+    for (const ModelIndex funcIndex: classInfo.funcs) {
+        const FuncInfo &func = typesInfo.funcs[funcIndex];
+        bool hasOverloads = func.overloads.size() > 1;
+
+        if (options.registrationTables && canBindByTable(typesInfo, func)) {
+            const OverloadInfo *longest = &func.overloads.front();
+            for (const auto &overload: func.overloads) {
+                if (overload.argCount > longest->argCount) {
+                    longest = &overload;
+                }
+            }
+            const FuncSigInfo &sig = typesInfo.signatures[longest->sig];
+            std::string_view funcName = func.name.empty() ? sig.name : func.name;
+            const auto args = typesInfo.overloadArgs(*longest);
+
+            methodDescs << "    {" << formatString(funcName) << ", " << formatString(func.doc) << ", ";
+            if (args.empty()) {
+                methodDescs << "nullptr";
+            } else {
+                methodDescs << classTableName(refClassName, "ArgNames") << " + " << argNames.size();
+            }
+            methodDescs << ", " << args.size() << ", " << (func.isStatic ? "true" : "false") << ", ";
+            genArgcThunk(methodDescs, cppClassName, typesInfo, func, funcName);
+            methodDescs << "},\n";
+            for (const auto &arg: args) {
+                argNames.push_back(arg.name);
+            }
+            continue;
+        }
 
-        for (size_t i = 0; i < func->overloads.size(); i++) {
-            const auto &overload = func->overloads[i];
+        if (options.arityDispatch && canDispatchByArity(typesInfo, func)) {
+            const FuncSigInfo &sig = typesInfo.signatures[func.overloads.front().sig];
+            std::string_view funcName = func.name.empty() ? sig.name : func.name;
 
-            std::string funcName = func->name.empty() ? overload.name : func->name;
+            code << (func.isStatic ? "\n    .staticFunc(" : "\n    .func(") << formatString(funcName) << ", ";
+            genArityDispatch(code, cppClassName, typesInfo, func, funcName);
+            code << ", ";
+            genFuncDoc(code, func, typesInfo.overloadArgs(func.overloads.back()));
+            code << ")";
+            continue;
+        }
 
-            if (func->isStatic) {
+        for (const auto &overload: func.overloads) {
+            const FuncSigInfo &sig = typesInfo.signatures[overload.sig];
+            const auto args = typesInfo.overloadArgs(overload);
+
+            std::string_view funcName = func.name.empty() ? sig.name : func.name;
+
+            if (func.isStatic) {
                 code << "\n    .staticFunc(";
             } else {
                 code << "\n    .func(";
             }
 
-            if (func->isMetaFunc) {
+            if (func.isMetaFunc) {
                 code << "MetaFunction::" << funcName << ", ";
             } else {
                 code << formatString(funcName) << ", ";
             }
 
             if (!hasOverloads) {
-                code << "&" << cppClassName << "::" << overload.name;
+                code << "&" << cppClassName << "::" << sig.name;
+            } else if (canCastOverload(func, sig, overload, args)) {
+                genOverloadPointer(code, cppClassName, func, sig, args);
             } else {
                 code << "[](";
-                if (!func->isStatic) {
+                if (!func.isStatic) {
                     code << cppClassName << " &self";
                 }
-                for (size_t k = 0; k < overload.argsNames.size(); k++) {
-                    if (k != 0 || !func->isStatic) {
+                for (size_t k = 0; k < args.size(); k++) {
+                    if (k != 0 || !func.isStatic) {
                         code << ", ";
                     }
-                    code << overload.argTypes[k] << " " << overload.argsNames[k];
+                    code << args[k].type << " " << args[k].name;
                 }
                 code << ") {\n";
                 code << "        ";
-                if (overload.retType != "void") {
+                if (sig.retType != "void") {
                     code << "return ";
                 }
-                if (!func->isStatic) {
-                    code << "self.";
+                if (!func.isStatic) {
+                    code << (sig.refQualifier == "&&" ? "std::move(self)." : "self.");
                 } else {
                     code << cppClassName << "::";
                 }
-                code << overload.name << "(";
-                for (size_t k = 0; k < overload.argsNames.size(); k++) {
+                code << sig.name << "(";
+                for (size_t k = 0; k < args.size(); k++) {
                     if (k != 0) {
                         code << ", ";
                     }
-                    code << overload.argsNames[k];
+                    code << args[k].name;
                 }
                 code << ");\n";
                 code << "    }";
             }
             code << ", ";
-            genFuncDoc(code, *func, i);
+            genFuncDoc(code, func, args);
             code << ")";
         }
     }
 
+    // 描述表在构建链的末尾注册，属性在函数之前，与构建链中的顺序一致
+    if (!argNames.empty()) {
+        tables << "static constexpr const char *" << classTableName(refClassName, "ArgNames") << "[] = {";
+        for (size_t i = 0; i < argNames.size(); i++) {
+            tables << (i == 0 ? "" : ", ") << "\"" << argNames[i] << "\"";
+        }
+        tables << "};\n";
+    }
+    if (propertyDescs.tellp() > 0) {
+        tables << "static constexpr autoany::PropertyDesc " << classTableName(refClassName, "Properties") << "[] = {\n"
+            << propertyDescs.str() << "};\n";
+        const std::string head = code.str();
+        code.str({});
+        code << "autoany::defProperties(" << head << ", " << classTableName(refClassName, "Properties") << ")";
+    }
+    if (methodDescs.tellp() > 0) {
+        tables << "static constexpr autoany::MethodDesc " << classTableName(refClassName, "Methods") << "[] = {\n"
+            << methodDescs.str() << "};\n";
+        const std::string head = code.str();
+        code.str({});
+        code << "autoany::defMethods(" << head << ", " << classTableName(refClassName, "Methods") << ")";
+    }
+
     code << ";";
 
+    // 类中的枚举与对应的枚举类共用同一张表
     for (const auto &e : interEnumInfos) {
         code << "\n\n";
-        code << genReflecEnumClassCode(e);
+        code << genEnumClassCode(typesInfo, e, false);
     }
 
+    return tables.str() + code.str();
+}
+
+std::string ToAnyGen::genLazyClassCode(const TypesInfo &typesInfo, const ClassInfo &classInfo, const std::string &classCode)
+{
+    const std::string cppClassName = classCppName(classInfo);
+    const std::string refClassName = classRefName(classInfo);
+
+    // 嵌套枚举在类的构建链中注册，按枚举名或类型查找时执行同一个注册函数
+    std::vector<LazyEntry> entries;
+    entries.push_back({cppClassName, classInfo.ns, refClassName});
+    for (const ModelIndex enumIndex: classInfo.enums) {
+        const EnumInfo &e = typesInfo.enums[enumIndex];
+        entries.push_back({cppClassName + "::" + std::string(e.cppName), classInfo.ns, refClassName + std::string(e.name)});
+    }
+
+    std::stringstream code;
+    genLazyEntry(code, classCode, classInfo.parents, entries);
     return code.str();
 }
 
-std::string ToAnyGen::genReflecEnumClassCode(const EnumClassInfo &enumClsInfo)
+std::string ToAnyGen::genLazyEnumClassCode(const EnumClassInfo &enumClsInfo, const std::string &enumCode)
+{
+    // REF_ENUM 的 C++ 类型由宏展开决定，只按名字登记
+    const LazyEntry entry{enumClsInfo.isDefEnum ? std::string() : std::string(enumClsInfo.cppName), enumClsInfo.ns,
+                          std::string(enumClsInfo.name)};
+
+    std::stringstream code;
+    genLazyEntry(code, enumCode, {}, {&entry, 1});
+    return code.str();
+}
+
+std::string_view ToAnyGen::lazyHeaderCode()
+{
+    return LAZY_HEADER_CODE;
+}
+
+std::string_view ToAnyGen::tableHeaderCode()
+{
+    return TABLE_HEADER_CODE;
+}
+
+std::string ToAnyGen::genProfiledCode(const std::string &code, std::string_view module, std::string_view header,
+                                      std::string_view name)
+{
+    std::stringstream os;
+    os << "{\n";
+    os << "    autoany::ScopedRegistrationTimer timer(" << formatString(module) << ", " << formatString(header) << ", "
+        << formatString(name) << ");\n";
+    appendIndented(os, code, "    ");
+    os << "}";
+    return os.str();
+}
+
+std::string ToAnyGen::qualifiedName(const ClassInfo &classInfo)
+{
+    const std::string refClassName = classRefName(classInfo);
+    return classInfo.ns.empty() ? refClassName : std::string(classInfo.ns) + "." + refClassName;
+}
+
+std::string ToAnyGen::qualifiedName(const EnumClassInfo &enumClsInfo)
+{
+    return enumClsInfo.ns.empty()
+               ? std::string(enumClsInfo.name)
+               : std::string(enumClsInfo.ns) + "." + std::string(enumClsInfo.name);
+}
+
+std::string_view ToAnyGen::profileHeaderCode()
+{
+    return PROFILE_HEADER_CODE;
+}
+
+void ToAnyGen::genLazyEntry(std::stringstream &os, const std::string &code, std::span<const std::string_view> parents,
+                            std::span<const LazyEntry> entries)
+{
+    os << "{\n";
+    os << "    const autoany::LazyClassTable::Thunk thunk = [] {\n";
+    // 父类的成员需要在子类使用前注册
+    for (const auto &parent: parents) {
+        os << "        autoany::LazyClassTable::instance().require<" << parent << ">();\n";
+    }
+    appendIndented(os, code, "        ");
+    os << "    };\n";
+    for (const auto &entry: entries) {
+        os << "    lazyTable.add";
+        if (!entry.cppType.empty()) {
+            os << "<" << entry.cppType << ">";
+        }
+        os << "(\"" << entry.ns << "\", \"" << entry.name << "\", thunk);\n";
+    }
+    os << "}";
+}
+
+std::string ToAnyGen::genReflecEnumClassCode(const TypesInfo &typesInfo, const EnumClassInfo &enumClsInfo)
+{
+    return genEnumClassCode(typesInfo, enumClsInfo, true);
+}
+
+bool ToAnyGen::needsEnumHeader(const TypesInfo &typesInfo)
+{
+    for (const auto &enumInfo: typesInfo.enumClasses) {
+        if (!enumInfo.isDefEnum && enumInfo.enumItems.count > 0) {
+            return true;
+        }
+    }
+    for (const auto &e: typesInfo.enums) {
+        if (e.enumItems.count > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view ToAnyGen::enumHeaderCode()
+{
+    return ENUM_HEADER_CODE;
+}
+
+std::string ToAnyGen::genEnumClassCode(const TypesInfo &typesInfo, const EnumClassInfo &enumClsInfo, bool declareTable)
 {
     std::stringstream code;
 
@@ -224,50 +1300,164 @@ std::string ToAnyGen::genReflecEnumClassCode(const EnumClassInfo &enumClsInfo)
         return code.str();
     }
 
-    std::string cppEnumClassName = enumClsInfo.cppName;
+    std::string_view cppEnumClassName = enumClsInfo.cppName;
+    const std::string enumRefName(enumClsInfo.name);
+    const auto items = typesInfo.items(enumClsInfo.enumItems);
+    const bool hasItems = !items.empty();
+    if (hasItems) {
+        if (declareTable) {
+            genEnumTable(code, cppEnumClassName, enumRefName, items);
+        }
+        code << "static constexpr auto " << enumIndexName(enumRefName) << " = autoany::makeEnumIndex("
+            << enumItemsName(enumRefName) << ");\n";
+        code << "static constexpr auto " << enumNamesName(enumRefName) << " = autoany::makeEnumNameHash("
+            << enumItemsName(enumRefName) << ");\n";
+    }
+
     // Begin
+    if (hasItems) {
+        code << "autoany::defEnumTable<" << (enumClsInfo.castTo.empty() ? cppEnumClassName : enumClsInfo.castTo) << ">(";
+    }
     code << "Class<" << cppEnumClassName << ">"
         << "(\"" << enumClsInfo.ns << "\", \"" << enumClsInfo.name << "\", " << formatString(enumClsInfo.doc) << ")";
-
-    std::string castTo = enumClsInfo.castTo;
-    code << "\n    .defEnum({\n";
-    for (const auto &ei: enumClsInfo.enumItems) {
-        code << "        {" << formatString(ei) << ", ";
-        if (!castTo.empty()) {
-            code << "static_cast<" << castTo << ">(";
-        }
-        code << cppEnumClassName << "::" << ei;
-        if (!castTo.empty()) {
-            code << ")";
-        }
-        code << "},\n";
+    if (hasItems) {
+        code << ", " << enumItemsName(enumRefName) << ")";
     }
-    code << "    })\n";
+    code << "\n";
 
     code << "    .func(MetaFunction::ToString, [](" << cppEnumClassName << " &self) {\n";
-    code << "        switch (self) {\n";
-    code << "            default: break;\n";
-    for (const auto &ei: enumClsInfo.enumItems) {
-        code << "            case " << cppEnumClassName << "::" << ei << " : " << "return " << formatString(ei) << ";\n";
+    if (hasItems) {
+        code << "        return " << enumIndexName(enumRefName) << ".name(self);\n";
+    } else {
+        code << "        return \"\";\n";
     }
-    code << "        }\n";
-    code << "        return \"\";\n";
     code << "    })\n";
 
+    // GAny 的 MetaFunction 没有 FromString，以同名静态函数注册；参数按 string_view 传给 find，查找本身不再复制名字
+    if (hasItems) {
+        code << "    .staticFunc(\"FromString\", [](const std::string &name) {\n"
+            << "        if (const auto *value = " << enumNamesName(enumRefName) << ".find(name)) {\n"
+            << "            return *value;\n"
+            << "        }\n"
+            << "        throw GAnyException(\"FromString: no item named \" + name);\n"
+            << "    })\n";
+    }
+
     code << "    REF_ENUM_OPERATORS(" << cppEnumClassName << ");";
 
     return code.str();
 }
 
-void ToAnyGen::genFuncDoc(std::stringstream &os, const FuncInfo &funcInfo, size_t overloadIndex)
+void ToAnyGen::genEnumTable(std::stringstream &os, std::string_view cppEnumName, std::string_view enumRefName,
+                            std::span<const std::string_view> items)
+{
+    os << "static constexpr autoany::EnumItem<" << cppEnumName << "> " << enumItemsName(enumRefName) << "[] = {\n";
+    for (const auto &ei: items) {
+        os << "    {" << cppEnumName << "::" << ei << ", " << formatString(ei) << "},\n";
+    }
+    os << "};\n";
+}
+
+void ToAnyGen::genFuncDoc(std::stringstream &os, const FuncInfo &funcInfo, std::span<const ArgInfo> args)
 {
     os << "{.doc=" << formatString(funcInfo.doc) << ", "
         << ".args={";
-    for (size_t i = 0; i < funcInfo.overloads[overloadIndex].argsNames.size(); i++) {
+    for (size_t i = 0; i < args.size(); i++) {
         if (i != 0) {
             os << ", ";
         }
-        os << "\"" << funcInfo.overloads[overloadIndex].argsNames[i] << "\"";
+        os << "\"" << args[i].name << "\"";
     }
     os << "}}";
 }
+
+void ToAnyGen::genOverloadPointer(std::stringstream &os, std::string_view cppClassName, const FuncInfo &funcInfo,
+                                  const FuncSigInfo &sig, std::span<const ArgInfo> args)
+{
+    os << "static_cast<" << sig.retType << " (";
+    if (!funcInfo.isStatic) {
+        os << cppClassName << "::";
+    }
+    os << "*)(";
+    for (size_t i = 0; i < args.size(); i++) {
+        if (i != 0) {
+            os << ", ";
+        }
+        os << args[i].type;
+    }
+    os << ")";
+    if (!funcInfo.isStatic) {
+        if (!sig.cvQualifier.empty()) {
+            os << " " << sig.cvQualifier;
+        }
+        if (!sig.refQualifier.empty()) {
+            os << " " << sig.refQualifier;
+        }
+    }
+    os << ">(&" << cppClassName << "::" << sig.name << ")";
+}
+
+void ToAnyGen::genArgcThunk(std::stringstream &os, std::string_view cppClassName, const TypesInfo &typesInfo,
+                            const FuncInfo &funcInfo, std::string_view funcName)
+{
+    const uint32_t firstArg = funcInfo.isStatic ? 0 : 1;
+    uint32_t minArgs = funcInfo.overloads.front().argCount;
+    uint32_t maxArgs = minArgs;
+
+    // 按参数个数分派，默认参数展开的 argc 连续，switch 编译为跳转表；截断的调用由编译器直接补上 C++ 默认参数
+    const bool usesArgs = !funcInfo.isStatic || std::any_of(funcInfo.overloads.begin(), funcInfo.overloads.end(),
+                                                            [](const OverloadInfo &overload) { return overload.argCount > 0; });
+    os << "[](const GAny **" << (usesArgs ? "args" : "") << ", int32_t argc) -> GAny {\n";
+    if (!funcInfo.isStatic) {
+        genThunkSelf(os, cppClassName, funcName, 1);
+    }
+    os << "        switch (argc";
+    if (firstArg != 0) {
+        os << " - " << firstArg;
+    }
+    os << ") {\n";
+    for (const auto &overload: funcInfo.overloads) {
+        const FuncSigInfo &sig = typesInfo.signatures[overload.sig];
+        const auto args = typesInfo.overloadArgs(overload);
+        minArgs = std::min(minArgs, overload.argCount);
+        maxArgs = std::max(maxArgs, overload.argCount);
+
+        os << "            case " << overload.argCount << ":\n";
+        os << "                ";
+        if (sig.retType != "void") {
+            os << "return ";
+        }
+        if (funcInfo.isStatic) {
+            os << cppClassName << "::";
+        } else {
+            os << (sig.refQualifier == "&&" ? "std::move(self)." : "self.");
+        }
+        os << sig.name << "(";
+        for (uint32_t k = 0; k < overload.argCount; k++) {
+            if (k != 0) {
+                os << ", ";
+            }
+            os << "args[" << k + firstArg << "]->castAs<" << argValueType(args[k].type) << ">()";
+        }
+        os << ");\n";
+        if (sig.retType == "void") {
+            os << "                return GAny();\n";
+        }
+    }
+    os << "            default:\n";
+    os << "                break;\n";
+    os << "        }\n";
+    const std::string expected = minArgs == maxArgs
+                                     ? std::to_string(minArgs)
+                                     : std::to_string(minArgs) + " to " + std::to_string(maxArgs);
+    os << "        throw GAnyException(" << formatString(std::string(funcName) + ": expected " + expected + " arguments") << ");\n";
+    os << "    }";
+}
+
+void ToAnyGen::genArityDispatch(std::stringstream &os, std::string_view cppClassName, const TypesInfo &typesInfo,
+                                const FuncInfo &funcInfo, std::string_view funcName)
+{
+    os << "GAnyFunction::createVariadicFunction(" << formatString(funcName) << ", " << formatString(funcInfo.doc) << ", ";
+    genArgcThunk(os, cppClassName, typesInfo, funcInfo, funcName);
+    os << ")";
+}
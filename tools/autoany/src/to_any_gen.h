@@ -13,12 +13,101 @@
 class ToAnyGen
 {
 public:
-    static std::string genReflecClassCode(const ClassInfo &classInfo);
+    /**
+     * 生成方式的选项，会改变生成的代码，需要计入增量清单的选项哈希.
+     */
+    struct Options
+    {
+        bool arityDispatch = false; // 默认参数展开的重载合并为一个按参数个数分派的可变参数绑定
+        bool lazyRegistration = false; // 模块加载时只登记类名到注册函数的映射，构建链在第一次 require 时执行
+        bool registrationTables = false; // 函数和属性生成静态描述表，由共用的注册函数循环注册
+        bool registrationProfile = false; // 每个头文件和每个类的注册过程计时
+    };
 
-    static std::string genReflecEnumClassCode(const EnumClassInfo &enumClsInfo);
+public:
+    static std::string genReflecClassCode(const TypesInfo &typesInfo, const ClassInfo &classInfo, const Options &options);
+
+    static std::string genReflecEnumClassCode(const TypesInfo &typesInfo, const EnumClassInfo &enumClsInfo);
+
+    /**
+     * 枚举反射使用的辅助头文件，生成到输出目录，ref 文件按相对路径引用.
+     */
+    static constexpr const char *ENUM_HEADER_FILE_NAME = "autoany_enum.h";
+
+    static bool needsEnumHeader(const TypesInfo &typesInfo);
+
+    static std::string_view enumHeaderCode();
+
+    /**
+     * 延迟注册模式下把类（连同嵌套枚举）或枚举类已经生成的反射代码包进注册函数，只生成登记代码.
+     * 生成的代码使用 ref 函数开头声明的 lazyTable.
+     */
+    static std::string genLazyClassCode(const TypesInfo &typesInfo, const ClassInfo &classInfo, const std::string &classCode);
+
+    static std::string genLazyEnumClassCode(const EnumClassInfo &enumClsInfo, const std::string &enumCode);
+
+    /**
+     * 把一段注册代码包进计时作用域，样本记录模块名、头文件和反射名（"命名空间.类名"，整个头文件时为空）.
+     */
+    static std::string genProfiledCode(const std::string &code, std::string_view module, std::string_view header,
+                                       std::string_view name);
+
+    static std::string qualifiedName(const ClassInfo &classInfo);
+
+    static std::string qualifiedName(const EnumClassInfo &enumClsInfo);
+
+    /**
+     * 延迟注册表所在的辅助头文件，延迟注册模式下生成到输出目录.
+     */
+    static constexpr const char *LAZY_HEADER_FILE_NAME = "autoany_lazy.h";
+
+    static std::string_view lazyHeaderCode();
+
+    /**
+     * 描述表模式下的描述结构和注册函数所在的辅助头文件.
+     */
+    static constexpr const char *TABLE_HEADER_FILE_NAME = "autoany_table.h";
+
+    static std::string_view tableHeaderCode();
+
+    /**
+     * 注册耗时统计所在的辅助头文件.
+     */
+    static constexpr const char *PROFILE_HEADER_FILE_NAME = "autoany_profile.h";
+
+    static std::string_view profileHeaderCode();
+
+    /**
+     * 转为带引号的 C++ 字符串字面量，转义反斜杠、引号和控制字符.
+     */
+    static std::string formatString(std::string_view value);
 
 private:
-    static void genFuncDoc(std::stringstream &os, const FuncInfo &funcInfo, size_t overloadIndex);
+    static std::string genEnumClassCode(const TypesInfo &typesInfo, const EnumClassInfo &enumClsInfo, bool declareTable);
+
+    struct LazyEntry
+    {
+        std::string cppType; // 为空时只按名字登记
+        std::string_view ns;
+        std::string name;
+    };
+
+    static void genLazyEntry(std::stringstream &os, const std::string &code, std::span<const std::string_view> parents,
+                             std::span<const LazyEntry> entries);
+
+    static void genEnumTable(std::stringstream &os, std::string_view cppEnumName, std::string_view enumRefName,
+                             std::span<const std::string_view> items);
+
+    static void genFuncDoc(std::stringstream &os, const FuncInfo &funcInfo, std::span<const ArgInfo> args);
+
+    static void genOverloadPointer(std::stringstream &os, std::string_view cppClassName, const FuncInfo &funcInfo,
+                                   const FuncSigInfo &sig, std::span<const ArgInfo> args);
+
+    static void genArgcThunk(std::stringstream &os, std::string_view cppClassName, const TypesInfo &typesInfo,
+                             const FuncInfo &funcInfo, std::string_view funcName);
+
+    static void genArityDispatch(std::stringstream &os, std::string_view cppClassName, const TypesInfo &typesInfo,
+                                 const FuncInfo &funcInfo, std::string_view funcName);
 };
 
 #endif //TO_ANY_GEN_H
@@ -0,0 +1,246 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#include "types_manifest.h"
+#include "json_string.h"
+#include "output_file.h"
+
+#include <gx/gfile.h>
+
+#include <iomanip>
+#include <sstream>
+
+
+static constexpr std::string_view HASH_FIELD = ", \"hash\": \"";
+
+static std::string hexHash(uint64_t hash)
+{
+    std::stringstream os;
+    os << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return os.str();
+}
+
+template<typename Range, typename Func>
+static void writeArray(std::stringstream &os, const Range &range, Func &&writeItem)
+{
+    os << "[";
+    bool first = true;
+    for (const auto &item: range) {
+        if (!first) {
+            os << ", ";
+        }
+        first = false;
+        writeItem(item);
+    }
+    os << "]";
+}
+
+static void writeFunc(std::stringstream &os, const TypesInfo &typesInfo, const FuncInfo &func)
+{
+    os << "{\"name\": " << jsonString(func.name)
+        << ", \"doc\": " << jsonString(func.doc)
+        << ", \"static\": " << (func.isStatic ? "true" : "false")
+        << ", \"meta\": " << (func.isMetaFunc ? "true" : "false")
+        << ", \"overloads\": ";
+    writeArray(os, func.overloads, [&](const OverloadInfo &overload) {
+        os << "{\"ret\": " << jsonString(typesInfo.signatures[overload.sig].retType) << ", \"args\": ";
+        writeArray(os, typesInfo.overloadArgs(overload), [&](const ArgInfo &arg) {
+            os << "{\"type\": " << jsonString(arg.type) << ", \"name\": " << jsonString(arg.name) << "}";
+        });
+        os << "}";
+    });
+    os << "}";
+}
+
+static void writeAccessor(std::stringstream &os, const TypesInfo &typesInfo, ModelIndex func)
+{
+    if (func == NO_INDEX) {
+        os << "null";
+    } else {
+        os << jsonString(typesInfo.funcs[func].name);
+    }
+}
+
+static void writeItems(std::stringstream &os, const TypesInfo &typesInfo, ModelRange range)
+{
+    writeArray(os, typesInfo.items(range), [&](std::string_view item) {
+        os << jsonString(item);
+    });
+}
+
+static void writeClass(std::stringstream &os, const TypesInfo &typesInfo, const ClassInfo &classInfo)
+{
+    os << "{\"name\": " << jsonString(classInfo.name)
+        << ", \"cppName\": " << jsonString(classInfo.cppName)
+        << ", \"ns\": " << jsonString(classInfo.ns)
+        << ", \"outerClass\": " << jsonString(classInfo.outerClass)
+        << ", \"doc\": " << jsonString(classInfo.doc)
+        << ", \"parents\": ";
+    writeArray(os, classInfo.parents, [&](std::string_view parent) {
+        os << jsonString(parent);
+    });
+
+    os << ", \"constructs\": ";
+    writeArray(os, classInfo.constructs, [&](ModelIndex func) {
+        writeFunc(os, typesInfo, typesInfo.funcs[func]);
+    });
+
+    os << ", \"funcs\": ";
+    writeArray(os, classInfo.funcs, [&](ModelIndex func) {
+        writeFunc(os, typesInfo, typesInfo.funcs[func]);
+    });
+
+    os << ", \"properties\": ";
+    writeArray(os, classInfo.properties, [&](ModelIndex index) {
+        const PropertyInfo &property = typesInfo.properties[index];
+        os << "{\"name\": " << jsonString(property.name)
+            << ", \"type\": " << jsonString(property.type)
+            << ", \"doc\": " << jsonString(property.doc)
+            << ", \"getter\": ";
+        writeAccessor(os, typesInfo, property.getter);
+        os << ", \"setter\": ";
+        writeAccessor(os, typesInfo, property.setter);
+        os << "}";
+    });
+
+    os << ", \"enums\": ";
+    writeArray(os, classInfo.enums, [&](ModelIndex index) {
+        const EnumInfo &enumInfo = typesInfo.enums[index];
+        os << "{\"name\": " << jsonString(enumInfo.name)
+            << ", \"cppName\": " << jsonString(enumInfo.cppName)
+            << ", \"castTo\": " << jsonString(enumInfo.castTo)
+            << ", \"doc\": " << jsonString(enumInfo.doc)
+            << ", \"items\": ";
+        writeItems(os, typesInfo, enumInfo.enumItems);
+        os << "}";
+    });
+
+    os << ", \"constants\": ";
+    writeArray(os, classInfo.constants, [&](const ConstantInfo &constant) {
+        os << jsonString(constant.name);
+    });
+
+    os << ", \"aliases\": ";
+    writeArray(os, classInfo.aliases, [&](const AliasInfo &alias) {
+        os << "{\"name\": " << jsonString(alias.newName) << ", \"oldName\": " << jsonString(alias.oldName) << "}";
+    });
+    os << "}";
+}
+
+std::string TypesManifest::fileName(const std::string &moduleName)
+{
+    return moduleName + ".types.json";
+}
+
+std::string TypesManifest::recordKey(std::string_view source, uint64_t hash)
+{
+    return "{\"source\": " + jsonString(source) + std::string(HASH_FIELD) + hexHash(hash) + "\"";
+}
+
+std::string TypesManifest::serialize(const TypesInfo &typesInfo, std::string_view source, uint64_t hash)
+{
+    std::stringstream os;
+    os << recordKey(source, hash)
+        << ", \"cppNamespace\": " << jsonString(typesInfo.cppNamespace)
+        << ", \"classes\": ";
+    writeArray(os, typesInfo.classes, [&](const ClassInfo &classInfo) {
+        writeClass(os, typesInfo, classInfo);
+    });
+
+    os << ", \"enumClasses\": ";
+    writeArray(os, typesInfo.enumClasses, [&](const EnumClassInfo &enumInfo) {
+        os << "{\"name\": " << jsonString(enumInfo.name)
+            << ", \"cppName\": " << jsonString(enumInfo.cppName)
+            << ", \"ns\": " << jsonString(enumInfo.ns)
+            << ", \"castTo\": " << jsonString(enumInfo.castTo)
+            << ", \"doc\": " << jsonString(enumInfo.doc)
+            << ", \"defEnum\": " << (enumInfo.isDefEnum ? "true" : "false")
+            << ", \"items\": ";
+        writeItems(os, typesInfo, enumInfo.enumItems);
+        os << "}";
+    });
+    os << "}";
+
+    return os.str();
+}
+
+bool TypesManifest::load(const std::string &filePath, const std::string &version)
+{
+    mRecords.clear();
+
+    GFile file(filePath);
+    if (!file.exists() || !file.open(GFile::ReadOnly)) {
+        return false;
+    }
+    const std::string content = file.readAll().toStdString();
+    file.close();
+
+    // 文件头的字段各占一行，与 save 的输出一致
+    const std::string formatLine = "\"format\": " + jsonString(FORMAT) + ",";
+    const std::string formatVersionLine = "\"formatVersion\": " + std::to_string(FORMAT_VERSION) + ",";
+    const std::string versionLine = "\"version\": " + jsonString(version) + ",";
+    bool hasFormat = false;
+    bool hasFormatVersion = false;
+    bool hasVersion = false;
+
+    std::istringstream input(content);
+    std::string line;
+    while (std::getline(input, line)) {
+        const size_t begin = line.find_first_not_of(' ');
+        if (begin == std::string::npos) {
+            continue;
+        }
+        std::string_view text = std::string_view(line).substr(begin);
+        hasFormat = hasFormat || text == formatLine;
+        hasFormatVersion = hasFormatVersion || text == formatVersionLine;
+        hasVersion = hasVersion || text == versionLine;
+        if (!text.starts_with("{\"source\": ")) {
+            continue;
+        }
+        if (text.ends_with(',')) {
+            text.remove_suffix(1);
+        }
+        // 键为记录开头到 hash 字段的右引号，哈希固定 16 位
+        const size_t hashPos = text.find(HASH_FIELD);
+        const size_t keyLength = hashPos + HASH_FIELD.size() + 17;
+        if (hashPos == std::string_view::npos || keyLength > text.size()) {
+            continue;
+        }
+        mRecords[std::string(text.substr(0, keyLength))] = std::string(text);
+    }
+
+    if (!hasFormat || !hasFormatVersion || !hasVersion) {
+        mRecords.clear();
+        return false;
+    }
+    return true;
+}
+
+const std::string *TypesManifest::find(std::string_view source, uint64_t hash) const
+{
+    const auto it = mRecords.find(recordKey(source, hash));
+    if (it == mRecords.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+bool TypesManifest::save(const std::string &filePath, const std::string &version, const std::string &moduleName,
+                         const std::vector<std::string_view> &records)
+{
+    std::stringstream os;
+    os << "{\n"
+        << "  \"format\": " << jsonString(FORMAT) << ",\n"
+        << "  \"formatVersion\": " << FORMAT_VERSION << ",\n"
+        << "  \"version\": " << jsonString(version) << ",\n"
+        << "  \"module\": " << jsonString(moduleName) << ",\n"
+        << "  \"headers\": [";
+    for (size_t i = 0; i < records.size(); i++) {
+        os << (i == 0 ? "\n" : ",\n") << "    " << records[i];
+    }
+    os << (records.empty() ? "]\n" : "\n  ]\n");
+    os << "}\n";
+
+    return OutputFile::writeIfChanged(filePath, os.str()) != OutputFile::WriteResult::Failed;
+}
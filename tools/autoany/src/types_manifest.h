@@ -0,0 +1,55 @@
+//
+// Created by Gxin on 26-10-17.
+//
+
+#ifndef TYPES_MANIFEST_H
+#define TYPES_MANIFEST_H
+
+#include "cpp_types_info_gen.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+/**
+ * 模块的类型清单：把每个头文件解析出的 TypesInfo 以 JSON 写出，其他工具无需重新解析头文件或加载模块即可读取接口信息.
+ * 每个头文件的记录占一行，以 {"source": ..., "hash": ...} 开头，增量生成时内容未变化的头文件直接沿用上次的记录.
+ */
+class TypesManifest
+{
+public:
+    static constexpr const char *FORMAT = "autoany-types";
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+public:
+    static std::string fileName(const std::string &moduleName);
+
+    /**
+     * 单个头文件的记录，不含换行.
+     */
+    static std::string serialize(const TypesInfo &typesInfo, std::string_view source, uint64_t hash);
+
+    /**
+     * 加载上一次写出的清单，文件不存在或格式、工具版本不符时返回 false 且没有记录.
+     */
+    bool load(const std::string &filePath, const std::string &version);
+
+    /**
+     * 源文件路径和内容哈希都一致时返回上次的记录.
+     */
+    const std::string *find(std::string_view source, uint64_t hash) const;
+
+    static bool save(const std::string &filePath, const std::string &version, const std::string &moduleName,
+                     const std::vector<std::string_view> &records);
+
+private:
+    static std::string recordKey(std::string_view source, uint64_t hash);
+
+private:
+    std::unordered_map<std::string, std::string> mRecords; // recordKey -> 记录
+};
+
+#endif //TYPES_MANIFEST_H
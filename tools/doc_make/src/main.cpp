@@ -18,8 +18,17 @@
 
 #include <getopt/getopt.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <map>
 #include <unordered_set>
 
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
 
 using namespace tools;
 
@@ -34,6 +43,21 @@ std::unique_ptr<MakeJsonDoc> sMakeJsonDoc;
 
 std::unique_ptr<MakeJsDoc> sMakeJsDoc;
 
+bool sProfile = false;
+
+/**
+ * 与 autoany --profile 生成的 autoany_profile.h 中的布局一致.
+ */
+struct AutoanyRegistrationSample
+{
+    const char *module;
+    const char *header;
+    const char *name;
+    uint64_t nanos;
+};
+
+using RegistrationProfileFunc = size_t (*)(const AutoanyRegistrationSample **samples);
+
 std::vector<std::shared_ptr<GAnyClass> > getAllClasses()
 {
     if (!pfnGanyGetEnv) {
@@ -130,6 +154,95 @@ bool foreachClass(GFile &dir)
     return true;
 }
 
+/**
+ * 在已加载的模块中查找 autoany_registration_profile_<Module>，模块名取文件名去掉扩展名和 lib 前缀.
+ */
+RegistrationProfileFunc findRegistrationProfile(const std::string &filePath)
+{
+    std::string name = GFile(filePath).fileName();
+    name = name.substr(0, name.find('.'));
+    std::vector<std::string> symbols = {"autoany_registration_profile_" + name};
+    if (name.starts_with("lib") && name.size() > 3) {
+        symbols.push_back("autoany_registration_profile_" + name.substr(3));
+    }
+
+#if defined(_WIN32)
+    HMODULE handle = LoadLibraryA(filePath.c_str());
+    if (!handle) {
+        return nullptr;
+    }
+    for (const auto &symbol: symbols) {
+        if (FARPROC func = GetProcAddress(handle, symbol.c_str())) {
+            return reinterpret_cast<RegistrationProfileFunc>(func);
+        }
+    }
+#else
+    // 模块已由 GAny::Load 加载，RTLD_NOLOAD 只取句柄
+    void *handle = dlopen(filePath.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+    if (!handle) {
+        return nullptr;
+    }
+    for (const auto &symbol: symbols) {
+        if (void *func = dlsym(handle, symbol.c_str())) {
+            dlclose(handle);
+            return reinterpret_cast<RegistrationProfileFunc>(func);
+        }
+    }
+    dlclose(handle);
+#endif
+    return nullptr;
+}
+
+/**
+ * 按模块、头文件和类分别汇总注册耗时，从高到低输出.
+ * 头文件的耗时包含其中立即注册的类，延迟注册的类单独计时.
+ */
+void printRegistrationProfile(const std::vector<AutoanyRegistrationSample> &samples)
+{
+    std::map<std::string, std::pair<uint64_t, uint64_t> > modules; // 头文件合计，类合计
+    std::vector<const AutoanyRegistrationSample *> headers;
+    std::vector<const AutoanyRegistrationSample *> classes;
+    for (const auto &sample: samples) {
+        auto &total = modules[sample.module];
+        if (*sample.name == '\0') {
+            total.first += sample.nanos;
+            headers.push_back(&sample);
+        } else {
+            total.second += sample.nanos;
+            classes.push_back(&sample);
+        }
+    }
+
+    const auto byTime = [](const AutoanyRegistrationSample *a, const AutoanyRegistrationSample *b) {
+        return a->nanos > b->nanos;
+    };
+    std::sort(headers.begin(), headers.end(), byTime);
+    std::sort(classes.begin(), classes.end(), byTime);
+
+    std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t> > > moduleList(modules.begin(), modules.end());
+    std::sort(moduleList.begin(), moduleList.end(), [](const auto &a, const auto &b) {
+        return a.second.first + a.second.second > b.second.first + b.second.second;
+    });
+
+    const auto ms = [](uint64_t nanos) {
+        return static_cast<double>(nanos) / 1e6;
+    };
+
+    fprintf(stdout, "Modules:\n");
+    fprintf(stdout, "  %12s %12s  %s\n", "headers(ms)", "classes(ms)", "module");
+    for (const auto &[module, total]: moduleList) {
+        fprintf(stdout, "  %12.3f %12.3f  %s\n", ms(total.first), ms(total.second), module.c_str());
+    }
+    fprintf(stdout, "\nHeaders:\n");
+    for (const AutoanyRegistrationSample *sample: headers) {
+        fprintf(stdout, "  %12.3f  %s  %s\n", ms(sample->nanos), sample->module, sample->header);
+    }
+    fprintf(stdout, "\nClasses:\n");
+    for (const AutoanyRegistrationSample *sample: classes) {
+        fprintf(stdout, "  %12.3f  %s  %s  %s\n", ms(sample->nanos), sample->module, sample->header, sample->name);
+    }
+}
+
 void printUsage(const char *program)
 {
     fprintf(stdout, R"TXT(Usage:
@@ -146,19 +259,23 @@ Options:
         lua: EmmyLua
     --output=string, -o string
         Output Path
+    --profile, -P
+        Print the registration time of the modules generated with autoany --profile, per module, header and class,
+        sorted from slowest, instead of generating documents.
 )TXT",
             program);
 }
 
 static int handleArguments(int argc, char *argv[])
 {
-    constexpr const char *OPT_STR = "hp:t:o:";
+    constexpr const char *OPT_STR = "hp:t:o:P";
 
     const static option OPTIONS[] = {
         {"help", no_argument, nullptr, 'h'},
         {"path", required_argument, nullptr, 'p'},
         {"type", required_argument, nullptr, 't'},
         {"output", required_argument, nullptr, 'o'},
+        {"profile", no_argument, nullptr, 'P'},
         {nullptr, 0, nullptr, 0}
     };
 
@@ -209,6 +326,9 @@ static int handleArguments(int argc, char *argv[])
             case 'o':
                 sOutputPath = arg;
                 break;
+            case 'P':
+                sProfile = true;
+                break;
         }
     }
 
@@ -238,6 +358,13 @@ int main(int argc, char *argv[])
         plugins.push_back(argv[argIndex]);
     }
 
+    // autoany --lazy 生成的模块默认只登记类名，文档需要完整的类数据库，加载前要求立即注册
+#if defined(_WIN32)
+    _putenv_s("AUTOANY_EAGER_REGISTRATION", "1");
+#else
+    setenv("AUTOANY_EAGER_REGISTRATION", "1", 1);
+#endif
+
     /// ======================================
     GANY_LOAD_MODULE(Gx);
 
@@ -247,6 +374,24 @@ int main(int argc, char *argv[])
         GAny::Load(f.filePath());
     }
 
+    if (sProfile) {
+        std::vector<AutoanyRegistrationSample> samples;
+        for (auto &p: plugins) {
+            GFile dir(sPath);
+            GFile f(dir, p);
+            RegistrationProfileFunc profileFunc = findRegistrationProfile(f.filePath());
+            if (!profileFunc) {
+                fprintf(stderr, "No registration profile in module: %s\n", f.filePath().c_str());
+                continue;
+            }
+            const AutoanyRegistrationSample *moduleSamples = nullptr;
+            const size_t count = profileFunc(&moduleSamples);
+            samples.insert(samples.end(), moduleSamples, moduleSamples + count);
+        }
+        printRegistrationProfile(samples);
+        return EXIT_SUCCESS;
+    }
+
     GFile dir(sOutputPath);
     if (!dir.exists()) {
         dir.mkdirs();